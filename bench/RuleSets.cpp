@@ -0,0 +1,164 @@
+/// @file RuleSets.cpp
+/// @brief Provides the definitions of the bundled rule sets
+
+#include "RuleSets.hpp"
+
+#include <cstdint>
+#include <format>
+
+/// @brief make a regex rule
+static RuleCase Regex(std::string pattern)
+{
+    return RuleCase{
+        .patternData = std::move(pattern),
+        .patternType = RuleCase::Pattern_t::REGEX,
+        .matchAlias = "",
+        .actionCode = ""
+    };
+}
+
+/// @brief generate distinct keywords of 3 to 10 random lowercase letters, an
+///        underscore and the index of the keyword in base 26. The letters come from
+///        a fixed linear congruential generator, so every run (and every platform)
+///        benchmarks the same words
+/// @param count the number of keywords
+static std::vector<std::string> Keywords(size_t count)
+{
+    std::vector<std::string> ret;
+    ret.reserve(count);
+
+    uint64_t seed = 0x2545F4914F6CDD1D;
+    auto Next = [&]()
+    {
+        seed = seed * 6364136223846793005 + 1442695040888963407;
+        return seed >> 33;
+    };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string word;
+        const size_t length = 3 + Next() % 8;
+        for (size_t letter = 0; letter < length; ++letter)
+        {
+            word.push_back(static_cast<char>('a' + Next() % 26));
+        }
+
+        /// the index as a suffix keeps the words distinct
+        ///
+        word.push_back('_');
+        size_t x = i;
+        do
+        {
+            word.push_back(static_cast<char>('a' + x % 26));
+            x /= 26;
+        } while (x > 0);
+        ret.push_back(std::move(word));
+    }
+    return ret;
+}
+
+/// @brief every keyword as its own rule, as in the keyword section of a lexer
+static RuleSet KeywordRules(size_t count)
+{
+    RuleSet ret{ .name = std::format("keywords-rules-{}", count), .rules = {} };
+    for (std::string& keyword : Keywords(count))
+    {
+        ret.rules.push_back(Regex(std::move(keyword)));
+    }
+    return ret;
+}
+
+/// @brief every keyword in a single alternation
+static RuleSet KeywordUnion(size_t count)
+{
+    std::string pattern;
+    for (const std::string& keyword : Keywords(count))
+    {
+        if (!pattern.empty()) pattern.push_back('|');
+        pattern += keyword;
+    }
+    return RuleSet{ .name = std::format("keywords-union-{}", count), .rules = { Regex(pattern) } };
+}
+
+/// @brief the rules of a lexer for c. '+' and '?' are not supported yet, so
+///        x+ is written as xx*, and '-' and '^' are escaped outside of classes
+static RuleSet CLexer()
+{
+    RuleSet ret{ .name = "c-lexer", .rules = {} };
+
+    for (const char* keyword : { "auto", "break", "case", "char", "const", "continue",
+        "default", "do", "double", "else", "enum", "extern", "float", "for", "goto", "if",
+        "int", "long", "register", "return", "short", "signed", "sizeof", "static",
+        "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while" })
+    {
+        ret.rules.push_back(Regex(keyword));
+    }
+
+    for (const char* pattern : {
+        "[a-zA-Z_][a-zA-Z0-9_]*", /// identifier
+        "0[xX][0-9a-fA-F][0-9a-fA-F]*[uUlL]*", /// hex integer
+        "[0-9][0-9]*[uUlL]*", /// decimal integer
+        "[0-9][0-9]*\\.[0-9]*([eE][-+]*[0-9][0-9]*)*[fFlL]*", /// floating point
+        "\"([^\"\\\\\n]|\\\\[^\n])*\"", /// string
+        "'([^'\\\\\n]|\\\\[^\n])([^'\\\\\n]|\\\\[^\n])*'", /// character
+        "//[^\n]*", /// line comment
+        "/\\*([^*]|\\*\\**[^*/])*\\*\\**/", /// block comment
+        "#[^\n]*", /// preprocessor line
+        "[ \t\n][ \t\n]*", /// whitespace
+        "\\->", "\\+\\+", "\\-\\-", "<<", ">>", "<=", ">=", "==", "!=", "&&", "\\|\\|",
+        "\\+=", "\\-=", "\\*=", "/=", "%=", "&=", "\\|=", "\\^=", "<<=", ">>=", "\\.\\.\\.",
+        "[-+*/%=<>!&|^~:;,.(){}\\[\\]]" })
+    {
+        ret.rules.push_back(Regex(pattern));
+    }
+    return ret;
+}
+
+/// @brief rules made of classes that span most of the alphabet and overlap
+///        each other, so the symbol classes are split finely
+static RuleSet LargeClasses()
+{
+    RuleSet ret{ .name = "large-classes", .rules = {} };
+    for (const char* pattern : {
+        "[ -~][ -~]*",
+        "[^\n][^\n]*",
+        "\\w\\w*",
+        "\\S\\S*",
+        "[^a-zA-Z0-9_ \t\n]",
+        "[!-/:-@\\[-`{-~][!-/:-@\\[-`{-~]*" })
+    {
+        ret.rules.push_back(Regex(pattern));
+    }
+    for (char c = 'b'; c <= 'z'; ++c)
+    {
+        ret.rules.push_back(Regex(std::format("[a-{0}][{0}-z]*[0-{1}]", c, (c - 'b') % 10)));
+    }
+    return ret;
+}
+
+/// @brief (a|b)*a(a|b)^(n-1), whose dfa must remember the last n symbols, so it
+///        has about 2^n states while the nfa has O(n)
+static RuleSet Blowup(size_t n)
+{
+    std::string pattern = "(a|b)*a";
+    for (size_t i = 1; i < n; ++i)
+    {
+        pattern += "(a|b)";
+    }
+    return RuleSet{ .name = std::format("blowup-{}", n), .rules = { Regex(pattern) } };
+}
+
+std::vector<RuleSet> RuleSets::All()
+{
+    return {
+        KeywordRules(100),
+        KeywordRules(1000),
+        KeywordUnion(1000),
+        KeywordUnion(2000),
+        CLexer(),
+        LargeClasses(),
+        Blowup(8),
+        Blowup(12),
+        Blowup(16)
+    };
+}
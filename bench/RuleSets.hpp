@@ -0,0 +1,24 @@
+/// @file RuleSets.hpp
+/// @brief Provides the rule sets the compile pipeline is benchmarked on
+
+#pragma once
+
+#include "RuleCase.hpp"
+
+#include <string>
+#include <vector>
+
+/// @brief a named set of rules, compiled together as the cases of one lexer
+struct RuleSet
+{
+    std::string name; ///< name of the set, as reported in the results
+    std::vector<RuleCase> rules; ///< the (unprocessed) rules of the set
+};
+
+/// @brief the bundled rule sets
+namespace RuleSets
+{
+    /// @brief get every bundled rule set: keyword lists, a c-like lexer, large
+    ///        classes and patterns whose dfa is exponentially larger than the nfa
+    std::vector<RuleSet> All();
+};
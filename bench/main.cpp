@@ -0,0 +1,300 @@
+/// @file main.cpp
+/// @brief Benchmark of the compile pipeline. Every bundled rule set is run through
+///        each stage separately, and the time, peak heap, state count and work
+///        counters (see Counters) of every stage are written as csv and/or json
+///
+/// usage: bench [--reps N] [--filter TEXT] [--csv FILE] [--json FILE]
+///        Without --csv, the csv is written to stdout. --filter keeps the rule sets
+///        whose name contains TEXT
+
+#include "RuleSets.hpp"
+
+#include "Counters.hpp"
+#include "DFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+#include "PreProcessor.hpp"
+#include "RuleCase.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <malloc.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// -----------------------------------------------------------------------------------------------
+/// Heap accounting
+/// -----------------------------------------------------------------------------------------------
+
+/// the global operator new and delete are replaced to count the heap in use, so the
+/// peak of a stage is the most it held at once above what was held when it started
+///
+static std::atomic<size_t> liveBytes{ 0 };
+static std::atomic<size_t> peakBytes{ 0 };
+
+static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+{
+    /// aligned_alloc needs the size to be a multiple of the alignment
+    ///
+    size = std::max<size_t>(size, 1);
+    void* ptr = (alignment <= alignof(std::max_align_t) ? std::malloc(size) 
+        : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment));
+    if (ptr == nullptr) throw std::bad_alloc();
+
+    const size_t bytes = malloc_usable_size(ptr);
+    const size_t live = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+    return ptr;
+}
+
+static void Deallocate(void* ptr)
+{
+    if (ptr == nullptr) return;
+    liveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    std::free(ptr);
+}
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* ptr) noexcept { Deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { Deallocate(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Deallocate(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Deallocate(ptr); }
+
+/// the arenas of the nfa (std::pmr) allocate with an explicit alignment
+///
+void* operator new(size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<size_t>(alignment)); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Deallocate(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Deallocate(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Deallocate(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { Deallocate(ptr); }
+
+/// -----------------------------------------------------------------------------------------------
+/// Stages
+/// -----------------------------------------------------------------------------------------------
+
+/// @brief the stages, in pipeline order. NFABuilder::Build preprocesses the rules
+///        itself, so the nfa stage includes the preprocess stage, and the dfa stage
+///        (the DFA constructor) includes laying out the nfa for the powerset
+static constexpr std::array<std::string_view, 4> STAGES = { "preprocess", "nfa", "dfa", "minimize" };
+
+/// @brief result of one stage on one rule set
+struct StageResult
+{
+    double ms; ///< fastest time of the repetitions, in milliseconds
+    size_t peakBytes; ///< most heap held at once by the stage (including its output)
+    size_t states; ///< number of states of the output, 0 for the preprocessor
+    Counters::Values counters; ///< work counted by the stage, in one repetition
+};
+
+/// @brief result of every stage on one rule set
+struct Result
+{
+    std::string set; ///< name of the rule set
+    size_t rules; ///< number of rules in the set
+    size_t patternBytes; ///< total length of the (unprocessed) patterns
+    std::array<StageResult, STAGES.size()> stages; ///< result of each stage
+};
+
+static size_t StatesOf(const std::vector<RuleCase>&) { return 0; }
+static size_t StatesOf(const NFA& nfa) { return nfa.states.size(); }
+static size_t StatesOf(const DFA& dfa) { return dfa.States().size(); }
+
+/// @brief run a stage a number of times
+/// @param reps the number of repetitions
+/// @param Prepare makes the input of a repetition, untimed
+/// @param Run runs the stage on the input, returning the output. The output is
+///        destroyed after the clock stops
+/// @return the fastest time, and the largest peak of the repetitions
+template <typename Prepare_t, typename Run_t>
+static StageResult Measure(size_t reps, Prepare_t&& Prepare, Run_t&& Run)
+{
+    StageResult ret{ .ms = std::numeric_limits<double>::infinity(), .peakBytes = 0, .states = 0, 
+        .counters = {} };
+    for (size_t rep = 0; rep < reps; ++rep)
+    {
+        auto input = Prepare();
+
+        const size_t before = liveBytes.load();
+        peakBytes.store(before);
+        Counters::Reset();
+        const auto start = std::chrono::steady_clock::now();
+        const auto output = Run(input);
+        const auto stop = std::chrono::steady_clock::now();
+
+        ret.ms = std::min(ret.ms, std::chrono::duration<double, std::milli>(stop - start).count());
+        ret.peakBytes = std::max(ret.peakBytes, peakBytes.load() - before);
+        ret.states = StatesOf(output);
+        ret.counters = Counters::Snapshot();
+    }
+    return ret;
+}
+
+/// @brief run every stage on a rule set
+static Result Bench(const RuleSet& set, size_t reps)
+{
+    Result ret{ .set = set.name, .rules = set.rules.size(), .patternBytes = 0, .stages = {} };
+    for (const RuleCase& rule : set.rules)
+    {
+        ret.patternBytes += rule.patternData.size();
+    }
+
+    auto CopyRules = [&]() { return set.rules; };
+    ret.stages[0] = Measure(reps, CopyRules, [](std::vector<RuleCase>& rules)
+    {
+        PreProcessor::PreProcess(rules);
+        return std::move(rules);
+    });
+    ret.stages[1] = Measure(reps, CopyRules, [](std::vector<RuleCase>& rules)
+    {
+        return NFABuilder::Build(std::move(rules));
+    });
+
+    /// the later stages each start from the output of the one before
+    ///
+    const NFA nfa = NFABuilder::Build(set.rules);
+    ret.stages[2] = Measure(reps, []() { return 0; }, [&](int) { return DFA(nfa); });
+
+    const DFA dfa(nfa);
+    ret.stages[3] = Measure(reps, [&]() { return dfa; }, [](DFA& input)
+    {
+        DFA::Minimize(input);
+        return std::move(input);
+    });
+    return ret;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Output
+/// -----------------------------------------------------------------------------------------------
+
+/// @brief write the results as csv, with a row per stage of every rule set
+static void WriteCSV(std::ostream& os, const std::vector<Result>& results)
+{
+    os << "set,rules,pattern_bytes,stage,ms,peak_bytes,states";
+    for (size_t counterI = 0; counterI < Counters::NUM_COUNTERS; ++counterI)
+    {
+        os << ',' << Counters::NameOf(static_cast<Counters::Counter_t>(counterI));
+    }
+    os << '\n';
+
+    for (const Result& result : results)
+    {
+        for (size_t stageI = 0; stageI < STAGES.size(); ++stageI)
+        {
+            const StageResult& stage = result.stages[stageI];
+            os << std::format("{},{},{},{},{:.3f},{},{}", result.set, result.rules,
+                result.patternBytes, STAGES[stageI], stage.ms, stage.peakBytes, stage.states);
+            for (size_t value : stage.counters.values)
+            {
+                os << ',' << value;
+            }
+            os << '\n';
+        }
+    }
+}
+
+/// @brief write the results as json, an array with an object per rule set. Set
+///        and stage names need no escaping
+static void WriteJSON(std::ostream& os, const std::vector<Result>& results)
+{
+    os << "[\n";
+    for (size_t resultI = 0; resultI < results.size(); ++resultI)
+    {
+        const Result& result = results[resultI];
+        os << std::format("  {{ \"set\": \"{}\", \"rules\": {}, \"pattern_bytes\": {}, \"stages\": {{\n",
+            result.set, result.rules, result.patternBytes);
+        for (size_t stageI = 0; stageI < STAGES.size(); ++stageI)
+        {
+            const StageResult& stage = result.stages[stageI];
+            os << std::format("    \"{}\": {{ \"ms\": {:.3f}, \"peak_bytes\": {}, \"states\": {}",
+                STAGES[stageI], stage.ms, stage.peakBytes, stage.states);
+            for (size_t counterI = 0; counterI < Counters::NUM_COUNTERS; ++counterI)
+            {
+                os << std::format(", \"{}\": {}", Counters::NameOf(static_cast<Counters::Counter_t>(counterI)),
+                    stage.counters.values[counterI]);
+            }
+            os << " }" << (stageI + 1 < STAGES.size() ? "," : "") << '\n';
+        }
+        os << "  } }" << (resultI + 1 < results.size() ? "," : "") << '\n';
+    }
+    os << "]\n";
+}
+
+/// @brief write the results to a file
+template <typename Write_t>
+static void WriteFile(const std::string& path, Write_t&& Write, const std::vector<Result>& results)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error(std::format("Could not open \"{}\"", path));
+    }
+    Write(file, results);
+}
+
+int main(int argc, char** argv)
+{
+    size_t reps = 3;
+    std::string filter, csvPath, jsonPath;
+    for (int argI = 1; argI < argc; ++argI)
+    {
+        const std::string_view arg = argv[argI];
+        if (argI + 1 == argc)
+        {
+            std::cerr << std::format("Missing value for {}\n", arg);
+            return EXIT_FAILURE;
+        }
+
+        const char* value = argv[++argI];
+        if (arg == "--reps") reps = std::max(1, std::atoi(value));
+        else if (arg == "--filter") filter = value;
+        else if (arg == "--csv") csvPath = value;
+        else if (arg == "--json") jsonPath = value;
+        else
+        {
+            std::cerr << std::format("Unknown option {}\n"
+                "usage: bench [--reps N] [--filter TEXT] [--csv FILE] [--json FILE]\n", arg);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        std::vector<Result> results;
+        for (const RuleSet& set : RuleSets::All())
+        {
+            if (set.name.find(filter) == std::string::npos) continue;
+
+            results.push_back(Bench(set, reps));
+            std::cerr << std::format("{}: {} nfa states, {} dfa states, {} minimized\n", set.name,
+                results.back().stages[1].states, results.back().stages[2].states,
+                results.back().stages[3].states);
+        }
+
+        if (csvPath.empty()) WriteCSV(std::cout, results);
+        else WriteFile(csvPath, WriteCSV, results);
+
+        if (!jsonPath.empty()) WriteFile(jsonPath, WriteJSON, results);
+    }
+    catch ( std::exception& e )
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/// @file CharClass.hpp
+/// @brief Provides CharClass, the set of bytes matched by a character class, and
+///        the tables of the common shorthand classes
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief set of bytes matched by a single regex operand, one bit per byte
+struct CharClass
+{
+    std::array<uint64_t, 4> bits{ }; ///< bit b % 64 of word b / 64 is set if b is in the class
+
+    /// @brief add a byte to the class
+    constexpr void Insert(uint8_t byte)
+    {
+        bits[byte / 64] |= (uint64_t{ 1 } << (byte % 64));
+    }
+
+    /// @brief add the (inclusive) range lo..hi of bytes to the class
+    constexpr void InsertRange(uint8_t lo, uint8_t hi)
+    {
+        for (size_t byte = lo; byte <= hi; ++byte)
+        {
+            Insert(static_cast<uint8_t>(byte));
+        }
+    }
+
+    /// @brief check if a byte is in the class
+    constexpr bool Contains(uint8_t byte) const
+    {
+        return (bits[byte / 64] >> (byte % 64)) & 1;
+    }
+
+    /// @brief get the number of bytes in the class
+    constexpr size_t Size() const
+    {
+        size_t ret = 0;
+        for (uint64_t word : bits)
+        {
+            ret += std::popcount(word);
+        }
+        return ret;
+    }
+
+    constexpr bool Empty() const { return Size() == 0; }
+
+    /// @brief get the bytes in either class
+    constexpr CharClass operator|(const CharClass& other) const
+    {
+        CharClass ret{ };
+        for (size_t i = 0; i < bits.size(); ++i)
+        {
+            ret.bits[i] = bits[i] | other.bits[i];
+        }
+        return ret;
+    }
+
+    /// @brief get the bytes in both classes
+    constexpr CharClass operator&(const CharClass& other) const
+    {
+        CharClass ret{ };
+        for (size_t i = 0; i < bits.size(); ++i)
+        {
+            ret.bits[i] = bits[i] & other.bits[i];
+        }
+        return ret;
+    }
+
+    /// @brief get the bytes of a universe that are not in this class
+    /// @param universe the bytes the class is negated within
+    constexpr CharClass NegatedIn(const CharClass& universe) const
+    {
+        CharClass ret{ };
+        for (size_t i = 0; i < bits.size(); ++i)
+        {
+            ret.bits[i] = ~bits[i] & universe.bits[i];
+        }
+        return ret;
+    }
+
+    /// @brief call a function on every maximal run of consecutive bytes in the
+    ///        class, in order
+    /// @param Visit called with the (inclusive) bounds lo, hi of each run
+    template <typename Visit_t>
+    constexpr void ForEachRange(Visit_t&& Visit) const
+    {
+        for (size_t byte = 0; byte < 256; ++byte)
+        {
+            if (!Contains(static_cast<uint8_t>(byte))) continue;
+
+            const size_t lo = byte;
+            while (byte < 255 && Contains(static_cast<uint8_t>(byte + 1))) ++byte;
+            Visit(static_cast<uint8_t>(lo), static_cast<uint8_t>(byte));
+        }
+    }
+
+    constexpr bool operator==(const CharClass&) const = default;
+
+    /// @brief get the class of the (inclusive) range lo..hi
+    static constexpr CharClass Range(uint8_t lo, uint8_t hi)
+    {
+        CharClass ret{ };
+        ret.InsertRange(lo, hi);
+        return ret;
+    }
+};
+
+/// @brief the shorthand classes, as written after a '\'
+namespace CharClasses
+{
+    /// @brief \d, the decimal digits
+    constexpr CharClass DIGIT = CharClass::Range('0', '9');
+
+    /// @brief \w, the word characters
+    constexpr CharClass WORD = CharClass::Range('a', 'z') | CharClass::Range('A', 'Z')
+        | DIGIT | CharClass::Range('_', '_');
+
+    /// @brief \s, the whitespace characters
+    constexpr CharClass SPACE = CharClass::Range('\t', '\r') | CharClass::Range(' ', ' ');
+};
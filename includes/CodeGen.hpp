@@ -0,0 +1,72 @@
+/// @file CodeGen.hpp
+/// @brief Provides the declarations for the CodeGen class, which emits C++ scanners
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+class DFA;
+struct RuleCase;
+
+/// @brief static class to generate a standalone, direct-coded C++ scanner from a dfa.
+///        Every dfa state becomes a label dispatching on the next byte with a switch,
+///        so the generated scanner needs no tables and no construction at runtime
+class CodeGen
+{
+public:
+    /// -----------------------------------------------------------------------
+    /// Explicitly delete constructors, destructor and operator=
+    /// -----------------------------------------------------------------------
+
+    CodeGen() = delete;
+    ~CodeGen() = delete;
+    CodeGen(const CodeGen&) = delete;
+    CodeGen(const CodeGen&&) = delete;
+    CodeGen& operator=(const CodeGen&) = delete;
+    CodeGen& operator=(const CodeGen&&) = delete;
+
+    /// -----------------------------------------------------------------------
+    /// Public api methods
+    /// -----------------------------------------------------------------------
+
+    /// @brief options controlling the generated code
+    struct Options
+    {
+        std::string nameSpace = "lexer"; ///< namespace of the generated scanner
+        std::string headerName = "lexer.hpp"; ///< name the source uses to include the header
+        std::string prologue; ///< code emitted before the scanner, such as includes the actions need
+    };
+
+    /// @brief method to emit the header of a generated scanner. It declares
+    ///        Token, Scan (one longest match) and Lex (scan, running actions)
+    /// @param os the stream to write the header to
+    /// @param options the generation options
+    static void EmitHeader(std::ostream& os, const Options& options);
+
+    /// @brief method to emit the source of a generated scanner
+    /// @param dfa the dfa to generate the scanner from
+    /// @param ruleCases the rule cases the dfa was built from (in order), whose
+    ///        action code is run when they are matched
+    /// @param os the stream to write the source to
+    /// @param options the generation options
+    static void EmitSource(const DFA& dfa, const std::vector<RuleCase>& ruleCases,
+        std::ostream& os, const Options& options);
+
+    /// @brief method to emit both the header and the source of a generated scanner
+    /// @param dfa the dfa to generate the scanner from
+    /// @param ruleCases the rule cases the dfa was built from (in order)
+    /// @param headerPath the path of the header file to write
+    /// @param sourcePath the path of the source file to write
+    /// @param options the generation options
+    static void Emit(const DFA& dfa, const std::vector<RuleCase>& ruleCases,
+        const char* headerPath, const char* sourcePath, const Options& options);
+
+private:
+    /// @brief method to emit the direct-coded longest match function
+    static void EmitScan(const DFA& dfa, std::ostream& os);
+
+    /// @brief method to emit the action dispatching lex function
+    static void EmitLex(const std::vector<RuleCase>& ruleCases, std::ostream& os);
+};
@@ -0,0 +1,54 @@
+/// @file CompactNFA.hpp
+/// @brief Provides the declarations for CompactNFA, the finalized, read-only
+///        layout of an NFA used by the matching engines
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct NFA;
+
+/// @brief nfa in compressed sparse row form. The transitions of every state are
+///        stored back to back in one array, with per-state offsets, so a traversal
+///        streams through memory instead of chasing a vector per state. Epsilon
+///        edges are kept apart from symbol edges, as closures only follow the former
+///        and moves only the latter. A symbol edge is labelled with an (inclusive)
+///        range of bytes
+struct CompactNFA
+{
+    /// @brief flatten an nfa. Symbol edges are clipped to the alphabet, as no engine
+    ///        ever moves on other bytes, and overlapping or adjacent ranges leading
+    ///        to the same state are merged
+    /// @param nfa the nfa
+    CompactNFA(const NFA& nfa);
+
+    /// @brief get the number of states
+    size_t NumStates() const { return tags.size(); }
+
+    /// @brief check if the nfa has no epsilon edges (see NFAOptimizer)
+    bool EpsilonFree() const { return epsilonTargets.empty(); }
+
+    /// @brief the epsilon closures of every state, back to back
+    struct Closures
+    {
+        std::vector<uint32_t> begin; ///< first entry of the closure of each state (+ sentinel)
+        std::vector<uint32_t> states; ///< the states of every closure
+    };
+
+    /// @brief compute the epsilon closure of every state, e.g. so a subset
+    ///        construction never follows epsilon edges itself
+    /// @return the closures, each starting with its own state
+    Closures EpsilonClosures() const;
+
+    uint32_t start; ///< the start state
+    size_t numCases; ///< the number of cases in the nfa
+    std::vector<uint32_t> symbolBegin; ///< first symbol edge of each state (+ sentinel)
+    std::vector<uint8_t> symbolLo; ///< lowest byte of every symbol edge, sorted by (source, lo)
+    std::vector<uint8_t> symbolHi; ///< highest byte of every symbol edge
+    std::vector<uint32_t> symbolTargets; ///< target of every symbol edge
+    std::vector<uint32_t> epsilonBegin; ///< first epsilon edge of each state (+ sentinel)
+    std::vector<uint32_t> epsilonTargets; ///< target of every epsilon edge, sorted per source
+    std::vector<uint32_t> tags; ///< packed case tag of every accepting state, else DFA::NO_TAG
+};
@@ -0,0 +1,85 @@
+/// @file Counters.hpp
+/// @brief Provides the Counters class, counts of the work done by the construction
+///        pipeline (nfa building, powerset construction and minimization)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+
+/// @brief static class holding process wide counts of the work done by the
+///        construction pipeline, summed over every construction since the last
+///        Reset. The counts are always kept: a construction counts into a local
+///        Batch, and only adds it to the counters once it is done
+class Counters
+{
+public:
+    /// -----------------------------------------------------------------------
+    /// Explicitly delete constructors, destructor and operator=
+    /// -----------------------------------------------------------------------
+    Counters() = delete;
+    ~Counters() = delete;
+    Counters(const Counters&) = delete;
+    Counters(const Counters&&) = delete;
+    Counters& operator=(const Counters&) = delete;
+    Counters& operator=(const Counters&&) = delete;
+
+    /// @brief the counters
+    enum class Counter_t : size_t
+    {
+        NFA_STATES = 0, ///< nfa states created (NFABuilder, NFAOptimizer)
+        DFA_STATES, ///< dfa states created by the powerset constructions
+        CLOSURES, ///< epsilon closures computed
+        WORKLIST_PUSHES, ///< states or blocks pushed on a construction work list
+        SPLITS, ///< blocks split by the minimization
+        BYTES_ALLOCATED, ///< bytes allocated for states, state sets and tables
+        COUNT ///< number of counters
+    };
+
+    static constexpr size_t NUM_COUNTERS = static_cast<size_t>(Counter_t::COUNT);
+
+    /// @brief the value of every counter, indexed by Counter_t
+    struct Values
+    {
+        std::array<size_t, NUM_COUNTERS> values{ };
+
+        size_t& operator[](Counter_t counter) { return values[static_cast<size_t>(counter)]; }
+        size_t operator[](Counter_t counter) const { return values[static_cast<size_t>(counter)]; }
+    };
+
+    /// @brief counts kept locally (so hot loops touch no shared memory), added
+    ///        to the counters when the batch is destroyed
+    class Batch
+    {
+    public:
+        Batch() = default;
+        ~Batch();
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        size_t& operator[](Counter_t counter) { return counts_[counter]; }
+
+    private:
+        Values counts_; ///< counts not yet added to the counters
+    };
+
+    /// @brief add to a counter
+    /// @param counter the counter
+    /// @param amount the amount to add
+    static void Add(Counter_t counter, size_t amount);
+
+    /// @brief get the value of every counter
+    static Values Snapshot();
+
+    /// @brief set every counter to 0
+    static void Reset();
+
+    /// @brief get the name of a counter, e.g. "nfa_states"
+    static std::string_view NameOf(Counter_t counter);
+
+    /// @brief get a memory resource that counts the bytes allocated through it
+    ///        (as BYTES_ALLOCATED), and gets them from the default resource
+    static std::pmr::memory_resource* Resource();
+};
@@ -3,11 +3,13 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
-#include <unordered_map>
-#include <unordered_set>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
+struct CompactNFA;
 struct NFA;
 
 /// @brief DFA class
@@ -18,23 +20,119 @@ public:
     {
         size_t index;
         size_t caseTag;
-        std::unordered_map<char, size_t> transitions;
     };
 
+    /// @brief packed form of NO_CASE_TAG, used by the tag table
+    static constexpr uint32_t NO_TAG = std::numeric_limits<uint32_t>::max();
+
+    /// @brief maximum number of byte ranges in the self-loop of an accelerated state
+    static constexpr size_t MAX_ACCEL_RANGES = 4;
+
+    /// @brief the self-loop of a state as byte ranges, so a scanner in the state can
+    ///        skip a run of looping bytes with a vectorized search instead of a
+    ///        table lookup per byte
+    struct Accel
+    {
+        uint32_t numRanges; ///< number of ranges, 0 if the state is not accelerated
+        std::array<uint8_t, MAX_ACCEL_RANGES> lo; ///< lowest byte of each range
+        std::array<uint8_t, MAX_ACCEL_RANGES> hi; ///< highest byte of each range
+    };
+
+    /// @brief non-owning view of the flat tables needed to run the dfa
+    struct Tables
+    {
+        const uint32_t* table; ///< row-major transition table
+        const uint8_t* classes; ///< byte -> symbol class map (256 entries)
+        const uint32_t* tags; ///< case tag of every state, NO_TAG if not accepting
+        const Accel* accels; ///< self-loop of every state, nullptr if none are accelerated
+        size_t numClasses; ///< number of symbol classes (columns of the table)
+        uint32_t start; ///< starting state index
+        uint32_t dead; ///< dead state index
+    };
+
+    /// @brief maps every input byte to its symbol class, i.e. the column of
+    ///        the transition table used for that byte
+    using ClassMap = std::array<uint8_t, 256>;
+
     DFA(const NFA& nfa);
 
+    /// @brief construct a dfa with a parallel powerset construction. The states
+    ///        are numbered in breadth first order from the start state (with the
+    ///        dead state second), so the dfa does not depend on the thread count
+    ///        or scheduling
+    /// @param nfa the nfa to construct the dfa from
+    /// @param numThreads the number of threads, 0 for one per hardware thread
+    DFA(const NFA& nfa, size_t numThreads);
+
     size_t Start() const;
     size_t Dead() const;
     const std::vector<State>& States() const;
 
+    /// @brief number of symbol classes (columns in each transition table row).
+    ///        Symbols in the same class are indistinguishable by the dfa
+    size_t NumClasses() const;
+
+    /// @brief the byte to symbol class map used to index the transition table
+    const ClassMap& Classes() const;
+
+    /// @brief the flat, row-major transition table. The row of state s starts
+    ///        at s * NumClasses(), and holds the destination of s for each class
+    const std::vector<uint32_t>& Table() const;
+
+    /// @brief get a view of the tables needed to run the dfa, valid for as long
+    ///        as the dfa is alive and unmodified
+    Tables View() const;
+
+    /// @brief get the state reached from a state upon reading a symbol
+    /// @param state the index of the state to transition from
+    /// @param symbol the symbol read
+    /// @return the index of the resulting state
+    size_t Next(size_t state, char symbol) const
+    {
+        return table_[state * numClasses_ + classMap_[static_cast<uint8_t>(symbol)]];
+    }
+
     static void Minimize(DFA& dfa);
 
+    /// @brief partition the bytes into the symbol classes of an nfa, where the
+    ///        symbols of a class label exactly the same nfa transitions. Class 0
+    ///        holds every byte without a transition (including those outside of
+    ///        the alphabet)
+    /// @param nfa the nfa
+    /// @param[out] classMap the class of every byte
+    /// @return the number of classes
+    static size_t ClassesOf(const CompactNFA& nfa, ClassMap& classMap);
+
 private:
     DFA();
-    static void Powerset(const NFA& nfa, DFA& dfa);
-    
+    static void Powerset(const CompactNFA& nfa, DFA& dfa);
+    static void ParallelPowerset(const CompactNFA& nfa, DFA& dfa, size_t numThreads);
+
+    /// @brief method to partition the bytes into symbol classes (see ClassesOf)
+    /// @param nfa the nfa the dfa is being constructed from
+    void InitClasses(const CompactNFA& nfa);
+
+    /// @brief method to merge the symbol classes that have identical columns in
+    ///        the transition table, narrowing every row of the table
+    void MergeClasses();
+
+    /// @brief method to find the states whose self-loop is a few byte ranges,
+    ///        which is how the states inside identifiers, whitespace runs, comments
+    ///        and string bodies look. Called once the table is final
+    void InitAccels();
+
+    /// @brief method to append a state (and its row in the transition table)
+    /// @param caseTag the case tag of the new state
+    /// @return the index of the new state
+    size_t NewState(size_t caseTag);
+
     size_t start_; ///< starting state index
     size_t deadState_; ///< dead state index
     size_t numCases_; ///< number of cases in this dfa
+    size_t numClasses_; ///< number of symbol classes (table columns)
+    ClassMap classMap_; ///< byte -> symbol class
     std::vector<State> states_; ///< state vector
+    std::vector<uint32_t> table_; ///< row-major transition table
+    std::vector<uint32_t> tags_; ///< packed case tag of every state
+    std::vector<Accel> accels_; ///< self-loop acceleration of every state
 };
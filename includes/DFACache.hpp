@@ -0,0 +1,80 @@
+/// @file DFACache.hpp
+/// @brief Provides the declarations for the DFACache class, an on-disk cache of
+///        constructed dfas keyed by their rule cases
+
+#pragma once
+
+#include "DFAImage.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct RuleCase;
+
+/// @brief content-addressed cache of minimized dfas in a local directory. The key of
+///        a rule set hashes what the automaton depends on (the order, pattern type
+///        and pattern data of every case, and the compiler version), so the same
+///        rules always find the same image, and action code changes do not
+///        invalidate it. An image holds the normalized rules it was built from, and
+///        is only served to the same rules, whatever the hash.
+///
+///        Images are written to a unique temporary file and published with rename(),
+///        so any number of processes may fill the cache concurrently: readers only
+///        ever see complete images, and racing writers publish identical content
+class DFACache
+{
+public:
+    /// @brief version of the construction of a dfa from rules (PreProcessor,
+    ///        NFABuilder, DFA). Bump it on any change to the automaton a rule set
+    ///        gets, so images built by an older compiler are never served
+    static constexpr uint32_t COMPILER_VERSION = 1;
+
+    /// @brief hit and miss counts of a cache
+    struct Stats
+    {
+        uint64_t hits; ///< rule sets served from an existing image
+        uint64_t misses; ///< rule sets constructed (and published)
+    };
+
+    /// @brief open a cache, creating its directory if needed
+    /// @param directory the directory holding the images
+    DFACache(std::string directory);
+
+    /// @brief get the dfa of a rule set, loading its image on a hit, or constructing,
+    ///        minimizing and publishing it on a miss. An unreadable image (e.g. one
+    ///        damaged on disk), or one built from other rules, is treated as a miss
+    ///        and replaced
+    /// @param ruleCases the rule cases
+    /// @return the image of the dfa
+    DFAImage Load(const std::vector<RuleCase>& ruleCases);
+
+    /// @brief get the hit and miss counts of this cache since it was opened
+    Stats Statistics() const;
+
+    /// @brief encode what the automaton of a rule set depends on: the compiler
+    ///        version, then the type and pattern of every case
+    /// @param ruleCases the rule cases
+    /// @return the normalized rules, stored in the image
+    static std::string Normalized(const std::vector<RuleCase>& ruleCases);
+
+    /// @brief compute the key of a rule set
+    /// @param ruleCases the rule cases
+    /// @return the key (a 64 bit fnv-1a hash of the normalized rules)
+    static uint64_t Key(const std::vector<RuleCase>& ruleCases);
+
+    /// @brief compute the key of normalized rules (see Normalized)
+    /// @param rules the normalized rules
+    /// @return the key (a 64 bit fnv-1a hash of the rules)
+    static uint64_t Key(std::string_view rules);
+
+    /// @brief get the path of the image of a key
+    std::string PathOf(uint64_t key) const;
+
+private:
+    std::string directory_; ///< the directory holding the images
+    std::atomic<uint64_t> hits_; ///< number of hits
+    std::atomic<uint64_t> misses_; ///< number of misses
+};
@@ -0,0 +1,87 @@
+/// @file DFAImage.hpp
+/// @brief Provides the declarations for the DFAImage class, a dfa saved to (and
+///        loaded from) a versioned binary file
+
+#pragma once
+
+#include "DFA.hpp"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/// @brief a dfa loaded from its binary image. The image is the flat tables of the
+///        dfa behind a small header, laid out so the loader memory maps the file
+///        and scans it in place: nothing is parsed, copied or allocated.
+///
+///        Layout (native byte order, every section 4 byte aligned):
+///          Header
+///          uint8_t  classes[256]                  byte -> symbol class
+///          uint32_t tags[numStates]               packed case tags
+///          DFA::Accel accels[numStates]           self-loop acceleration
+///          uint32_t table[numStates * numClasses] row-major transitions
+///          uint8_t  rules[rulesSize]              the rules built from, zero padded
+///                                                 to 4 bytes
+class DFAImage
+{
+public:
+    /// @brief the image format version, bumped on any layout change
+    static constexpr uint32_t VERSION = 3;
+
+    /// @brief the first word of an image ("LDFA"), read back in the wrong byte
+    ///        order when the image was written on a machine of another endianness
+    static constexpr uint32_t MAGIC = 0x4C444641;
+
+    struct Header
+    {
+        uint32_t magic; ///< MAGIC
+        uint32_t version; ///< VERSION of the writer
+        uint32_t numStates; ///< number of states (rows of the table)
+        uint32_t numClasses; ///< number of symbol classes (columns of the table)
+        uint32_t start; ///< starting state index
+        uint32_t dead; ///< dead state index
+        uint32_t checksum; ///< fnv-1a hash of every word after the header
+        uint32_t rulesSize; ///< size of the rules, without the padding
+    };
+
+    /// @brief write the image of a dfa to a file
+    /// @param dfa the dfa
+    /// @param path the path of the file to write
+    /// @param rules the rules the dfa was built from, in the writer's own encoding
+    ///        (see DFACache::Normalized), so a reader can check what it loads
+    static void Write(const DFA& dfa, const char* path, std::string_view rules = { });
+
+    /// @brief map and validate the image of a dfa. The file is rejected if it is
+    ///        truncated, of another version or byte order, fails its checksum,
+    ///        holds a state or class out of range, or accelerates a state over
+    ///        bytes that are not its self-loop
+    /// @param path the path of the image
+    DFAImage(const char* path);
+
+    /// @brief get a view of the tables of the dfa, valid for as long as the image
+    DFA::Tables View() const;
+
+    /// @brief get the number of states of the dfa
+    size_t NumStates() const;
+
+    /// @brief get the rules the dfa was built from, as written (see Write)
+    std::string_view Rules() const;
+
+private:
+    /// @brief compute the checksum of the words after the header
+    /// @param words the first word after the header
+    /// @param count the number of words
+    static uint32_t Checksum(const uint32_t* words, size_t count);
+
+    /// @brief get the size of an image holding a dfa of the given dimensions
+    static size_t ImageSize(size_t numStates, size_t numClasses, size_t rulesSize);
+
+    MappedFile file_; ///< the mapped image
+    Header header_; ///< the header of the image
+    const uint8_t* classes_; ///< class map in the mapping
+    const uint32_t* tags_; ///< tags in the mapping
+    const DFA::Accel* accels_; ///< self-loop acceleration in the mapping
+    const uint32_t* table_; ///< transition table in the mapping
+    const char* rules_; ///< rules in the mapping
+};
@@ -0,0 +1,140 @@
+/// @file LazyDFA.hpp
+/// @brief Provides the declarations for the LazyDFA class, which determinizes an
+///        nfa on demand while scanning
+
+#pragma once
+
+#include "CompactNFA.hpp"
+#include "DFA.hpp"
+#include "PikeVM.hpp"
+#include "Scanner.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct NFA;
+
+/// @brief dfa built lazily from an nfa. A subset state, and each of its transitions,
+///        is only constructed the first time the input reaches it, and kept in a
+///        cache of bounded size. A full cache is flushed and refilled from the
+///        current state. If flushes come so often that states are rebuilt more than
+///        they are used, the cache is thrashing, and scanning falls back to a PikeVM,
+///        which takes over the nfa. Produces the same tokens as a Scanner over the
+///        dfa of the nfa
+class LazyDFA
+{
+public:
+    /// @brief default number of states the cache holds
+    static constexpr size_t DEFAULT_MAX_STATES = 4096;
+
+    /// @brief counters of a lazy dfa since it was created
+    struct Stats
+    {
+        size_t statesBuilt; ///< subset states constructed (including rebuilt ones)
+        size_t flushes; ///< times the cache was flushed
+        bool fellBack; ///< if scanning has fallen back to the PikeVM
+    };
+
+    /// @brief prepare an nfa for lazy determinization
+    /// @param nfa the nfa, only used during construction
+    /// @param maxStates the number of states the cache holds, at least 2
+    LazyDFA(const NFA& nfa, size_t maxStates = DEFAULT_MAX_STATES);
+
+    /// @brief find the longest match starting at an offset of the input, ties going
+    ///        to the lowest numbered case. When no case matches a (non-empty) prefix,
+    ///        a single byte token tagged NO_CASE_TAG is produced
+    /// @param input the input
+    /// @param offset the offset of the token, less than the input size
+    /// @return the token
+    Token MunchAt(std::string_view input, size_t offset);
+
+    /// @brief tokenize a whole input
+    /// @param input the input
+    /// @return every token of the input
+    std::vector<Token> Tokenize(std::string_view input);
+
+    /// @brief get the counters of this lazy dfa
+    Stats Statistics() const;
+
+private:
+    /// @brief transition not constructed yet
+    static constexpr uint32_t UNKNOWN = std::numeric_limits<uint32_t>::max();
+
+    /// @brief the empty subset, never cached
+    static constexpr uint32_t DEAD = UNKNOWN - 1;
+
+    /// @brief a flush is thrashing when fewer bytes than this were scanned per
+    ///        state built since the previous flush
+    static constexpr size_t MIN_BYTES_PER_STATE = 10;
+
+    /// @brief number of thrashing flushes in a row before falling back
+    static constexpr size_t MAX_THRASHING_FLUSHES = 3;
+
+    /// @brief hash of a sorted nfa state set
+    struct SetHash
+    {
+        size_t operator()(const std::vector<uint32_t>& set) const;
+    };
+
+    /// @brief get the cached start state, building it if needed
+    uint32_t Start();
+
+    /// @brief get the state reached from a state on a symbol class, building it
+    ///        (and possibly flushing the cache) if needed
+    /// @param state the state, valid in the current cache
+    /// @param symbolClass the symbol class
+    /// @return the state reached, valid in the (possibly flushed) cache, or DEAD
+    uint32_t Next(uint32_t state, uint8_t symbolClass);
+
+    /// @brief find or build the state of a sorted nfa state set
+    /// @param set the set
+    /// @return the state, or DEAD for the empty set
+    uint32_t StateOf(const std::vector<uint32_t>& set);
+
+    /// @brief drop every cached state
+    void Flush();
+
+    /// @brief check if enough thrashing flushes came in a row to fall back
+    bool Thrashing() const { return thrashingFlushes_ >= MAX_THRASHING_FLUSHES; }
+
+    /// @brief fall back to the vm, moving the nfa into it and releasing the cache
+    void FallBack();
+
+    /// nfa, and its symbol classes
+    ///
+    CompactNFA nfa_; ///< the nfa
+    DFA::ClassMap classes_; ///< byte -> symbol class
+    size_t numClasses_; ///< number of symbol classes
+    std::vector<uint8_t> classFirst_; ///< the first byte of every symbol class
+    CompactNFA::Closures closures_; ///< epsilon closure of every nfa state
+
+    /// the cache
+    ///
+    size_t maxStates_; ///< the number of states the cache holds
+    uint32_t start_; ///< the cached start state, UNKNOWN if not built
+    std::vector<uint32_t> table_; ///< row-major transitions of the cached states
+    std::vector<uint32_t> tags_; ///< packed case tag of every cached state
+    std::vector<const std::vector<uint32_t>*> setOf_; ///< nfa state set of every cached state
+    std::unordered_map<std::vector<uint32_t>, uint32_t, SetHash> stateOf_; ///< set -> state
+
+    /// scratch of the subset construction
+    ///
+    std::vector<uint32_t> mark_; ///< generation an nfa state was last added in
+    uint32_t generation_; ///< the current generation
+    std::vector<uint32_t> scratch_; ///< the set being built
+
+    /// thrash detection and fallback
+    ///
+    size_t bytesSinceFlush_; ///< bytes scanned since the last flush
+    size_t builtSinceFlush_; ///< states built since the last flush
+    size_t thrashingFlushes_; ///< thrashing flushes in a row
+    size_t statesBuilt_; ///< states built in total
+    size_t flushes_; ///< flushes in total
+    bool fellBack_; ///< if scanning has fallen back to the vm
+    std::optional<PikeVM> fallback_; ///< the vm scanned with once the cache thrashes
+};
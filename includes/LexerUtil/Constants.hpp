@@ -4,23 +4,27 @@
 
 #pragma once
 
+#include "CharClass.hpp"
+
 #include <limits>
 #include <cstddef>
 #include <unordered_set>
 
-/// @brief The alphabet used by the project. Includes printable ASCII 
+/// @brief The alphabet used by the project, as a class. Includes printable ASCII 
 ///        characters, EOF, tab, and newline.
+constexpr CharClass ALPHABET_CLASS = CharClass::Range(32, 127) | CharClass::Range('\t', '\n');
+
+/// @brief The alphabet used by the project (see ALPHABET_CLASS)
 const std::unordered_set<char> ALPHABET = []()
 {
     std::unordered_set<char> ret{ };
-    for (int c = 32; c < 128; ++c)
+    ALPHABET_CLASS.ForEachRange([&ret](uint8_t lo, uint8_t hi)
     {
-        //DBG << (char) c << std::endl;
-        ret.insert((char)c);
-    }
-    ret.insert('\t');
-    ret.insert('\n');
-    
+        for (size_t c = lo; c <= hi; ++c)
+        {
+            ret.insert((char)c);
+        }
+    });
     return ret;
 }();
 
@@ -3,12 +3,16 @@
 
 #pragma once
 
+#include "DFA.hpp"
 #include "LexerUtil/Constants.hpp"
 #include "LexerUtil/Misc.hpp"
 #include "LexerUtil/Macros.hpp"
 #include "LexerUtil/Macros.hpp"
 
 #include <fstream>
+#include <string>
+#include <unordered_map>
+#include <type_traits>
 
 template <typename SM_t>
 static void DrawStateMachine(const SM_t& sm, const char * const outFilePath)
@@ -32,9 +36,21 @@ static void DrawStateMachine(const SM_t& sm, const char * const outFilePath)
     for (const auto& state : sm.States())
     {
         labelMap[state.index];
-        for (const auto& [symbol, result] : state.transitions)
+        if constexpr (std::is_same_v<SM_t, DFA>)
         {
-            labelMap[state.index][result] += Escaped(symbol);
+            /// dfa transitions live in the flat transition table
+            for (char symbol : ALPHABET)
+            {
+                labelMap[state.index][sm.Next(state.index, symbol)] += Escaped(symbol);
+            }
+        }
+        else
+        {
+            for (const auto& [lo, hi, result] : state.transitions)
+            {
+                labelMap[state.index][result] += (lo == hi ? Escaped(lo) 
+                    : std::format("[{}-{}]", Escaped(lo), Escaped(hi)));
+            }
         }
         for (const auto& [result, label] : labelMap[state.index])
         {
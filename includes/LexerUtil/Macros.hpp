@@ -4,8 +4,6 @@
 
 #pragma once
 
-#include "NullStream.hpp"
-
 #include <iostream>
 #include <stdexcept>
 #include <format>
@@ -49,11 +47,29 @@ inline void ThrowIFNTrue(bool cond, const char * const file,
 
 #define UNREACHABLE() __builtin_unreachable()
 
-/// @brief Debug output stream. In release mode, this outputs to a null stream. 
-///        In debug mode, this outputs to DBG.
+/// @brief trace levels, from least to most detailed
+#define TRACE_LEVEL_OFF 0 ///< no tracing
+#define TRACE_LEVEL_INFO 1 ///< a line per phase of the pipeline
+#define TRACE_LEVEL_DEBUG 2 ///< a line per step of a phase
+#define TRACE_LEVEL_VERBOSE 3 ///< a line per state and symbol, inside the hot loops
+
+/// @brief the most detailed level traced. Defaults to every level in debug mode,
+///        and none otherwise. Set with -DTRACE_LEVEL=TRACE_LEVEL_INFO (for example)
+#ifndef TRACE_LEVEL
 #ifdef DEBUG_MODE
 #warning "Debug mode enabled"
-#define DBG std::cout
+#define TRACE_LEVEL TRACE_LEVEL_VERBOSE
 #else
-#define DBG nullout
-#endif
\ No newline at end of file
+#define TRACE_LEVEL TRACE_LEVEL_OFF
+#endif
+#endif
+
+/// @brief macro to run a statement only if a trace level is enabled, e.g. 
+///        TRACE_DO(DEBUG, Debug(fragment)). A disabled statement is still type 
+///        checked, but is discarded at compile time, so nothing in it is evaluated
+#define TRACE_DO(xLevel, ...) \
+    do { if constexpr (TRACE_LEVEL >= TRACE_LEVEL_##xLevel) { __VA_ARGS__; } } while (0)
+
+/// @brief macro to write to the trace output (std::cout) only if a trace level is 
+///        enabled, e.g. TRACE(INFO, "built " << n << " states" << std::endl)
+#define TRACE(xLevel, ...) TRACE_DO(xLevel, std::cout << __VA_ARGS__)
\ No newline at end of file
@@ -7,11 +7,12 @@
 #include <stack>
 #include <string>
 #include <sstream>
+#include <utility>
 
-template <typename SM_t>
-SM_t pop(std::stack<SM_t>& stk) 
+template <typename SM_t, typename Container_t>
+SM_t pop(std::stack<SM_t, Container_t>& stk) 
 {
-    SM_t val = stk.top();
+    SM_t val = std::move(stk.top());
     stk.pop();
     return val;
 }
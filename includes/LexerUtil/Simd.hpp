@@ -0,0 +1,110 @@
+/// @file Simd.hpp
+/// @brief Vectorized byte search kernels used by the scanners, with a scalar
+///        fallback for targets without SSE2
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/// @brief find the first byte of a run whose membership in a set of byte ranges is
+///        the one requested
+/// @tparam Member true to find the first byte in a range, false to find the first
+///         byte outside of every range
+/// @param first the first byte of the run
+/// @param last one past the last byte of the run
+/// @param lo the lowest byte of each range
+/// @param hi the highest byte of each range
+/// @param count the number of ranges, at most 4
+/// @return the byte found, or last if there is none
+template <bool Member>
+inline const uint8_t* FindByRanges(const uint8_t* first, const uint8_t* last,
+    const uint8_t* lo, const uint8_t* hi, size_t count)
+{
+    /// a byte x is in [lo, hi] exactly when (x - lo) <= (hi - lo) as unsigned
+    /// bytes, which is a subtraction and an unsigned min per range
+    ///
+#if defined(__AVX2__)
+    {
+        __m256i los[4];
+        __m256i widths[4];
+        for (size_t i = 0; i < count; ++i)
+        {
+            los[i] = _mm256_set1_epi8(static_cast<char>(lo[i]));
+            widths[i] = _mm256_set1_epi8(static_cast<char>(hi[i] - lo[i]));
+        }
+        while (last - first >= 32)
+        {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            __m256i member = _mm256_setzero_si256();
+            for (size_t i = 0; i < count; ++i)
+            {
+                const __m256i offset = _mm256_sub_epi8(bytes, los[i]);
+                member = _mm256_or_si256(member,
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(offset, widths[i]), offset));
+            }
+            const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(member));
+            const uint32_t found = (Member ? mask : ~mask);
+            if (found != 0) return first + __builtin_ctz(found);
+            first += 32;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        __m128i los[4];
+        __m128i widths[4];
+        for (size_t i = 0; i < count; ++i)
+        {
+            los[i] = _mm_set1_epi8(static_cast<char>(lo[i]));
+            widths[i] = _mm_set1_epi8(static_cast<char>(hi[i] - lo[i]));
+        }
+        while (last - first >= 16)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            __m128i member = _mm_setzero_si128();
+            for (size_t i = 0; i < count; ++i)
+            {
+                const __m128i offset = _mm_sub_epi8(bytes, los[i]);
+                member = _mm_or_si128(member,
+                    _mm_cmpeq_epi8(_mm_min_epu8(offset, widths[i]), offset));
+            }
+            const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(member));
+            const uint32_t found = (Member ? mask : ~mask & 0xFFFFu);
+            if (found != 0) return first + __builtin_ctz(found);
+            first += 16;
+        }
+    }
+#endif
+    for (; first != last; ++first)
+    {
+        bool member = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            member |= (static_cast<uint8_t>(*first - lo[i]) <= static_cast<uint8_t>(hi[i] - lo[i]));
+        }
+        if (member == Member) break;
+    }
+    return first;
+}
+
+/// @brief find the first byte of a run that is in none of a set of byte ranges
+/// @return the first byte outside of every range, or last if there is none
+inline const uint8_t* FindNotInRanges(const uint8_t* first, const uint8_t* last,
+    const uint8_t* lo, const uint8_t* hi, size_t count)
+{
+    return FindByRanges<false>(first, last, lo, hi, count);
+}
+
+/// @brief find the first byte of a run that is in one of a set of byte ranges. A
+///        range of a single byte makes this a search for any of a few bytes
+/// @return the first byte in a range, or last if there is none
+inline const uint8_t* FindInRanges(const uint8_t* first, const uint8_t* last,
+    const uint8_t* lo, const uint8_t* hi, size_t count)
+{
+    return FindByRanges<true>(first, last, lo, hi, count);
+}
@@ -0,0 +1,38 @@
+/// @file MappedFile.hpp
+/// @brief Provides the declarations for the MappedFile class, a read-only memory
+///        mapping of a file
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/// @brief read-only, private memory mapping of a whole file. The mapping is advised
+///        for sequential access (and transparent huge pages where supported), so
+///        scanning it runs at page cache speed without copying the file
+class MappedFile
+{
+public:
+    /// @brief map a file
+    /// @param path the path of the file to map
+    MappedFile(const char* path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// @brief get a view of the mapped file, valid for as long as the mapping
+    std::string_view View() const;
+
+    /// @brief get the size of the mapped file in bytes
+    size_t Size() const;
+
+private:
+    /// @brief unmap the file, if mapped
+    void Unmap();
+
+    void* data_; ///< start of the mapping (nullptr for an empty file)
+    size_t size_; ///< size of the mapping in bytes
+};
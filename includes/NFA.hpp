@@ -3,18 +3,27 @@
 
 #pragma once
 
+#include "LexerUtil/Constants.hpp"
+
 #include <vector>
 #include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <unordered_set>
 
 /// @brief Represents a Non-deterministic Finite Automaton (NFA)
 struct NFA
 {
-    /// @brief  Represents a transition from one state to another
+    /// @brief  Represents a transition from one state to another, on any symbol
+    ///         of the (inclusive) range lo..hi. Epsilon transitions have the range
+    ///         EPSILON..EPSILON
     struct Transition
     {
-        char symbol; ///< The input symbol for the transition
+        char lo; ///< The lowest input symbol of the transition
+        char hi; ///< The highest input symbol of the transition
         size_t to; ///< The index of the result state
+
+        bool IsEpsilon() const { return lo == EPSILON; }
     };
 
     /// @brief Represents a state in the NFA
@@ -22,15 +31,20 @@ struct NFA
     {
         const size_t index; ///< The index of the state
         const size_t caseTag; ///< The case tag associated with the state (if any)
-        std::vector<Transition> transitions; ///< the transitions from this state
+        std::pmr::vector<Transition> transitions; ///< the transitions from this state
     };
 
+    /// the memory the states and transitions are allocated from (null for the default
+    /// resource), freed all at once with the nfa. Declared first, so it outlives them
+    ///
+    std::shared_ptr<std::pmr::memory_resource> arena;
+
     size_t start; ///< The index of the start state
     std::unordered_set<size_t> accept; ///< The indices of the accept states
-    std::vector<State> states; ///< The states of the NFA
+    std::pmr::vector<State> states; ///< The states of the NFA
     size_t numCases; ///< the number of cases in this NFA
 
     const std::unordered_set<size_t> & Accepting() const { return accept; }
-    const std::vector<State>& States() const { return states; }
+    const std::pmr::vector<State>& States() const { return states; }
     size_t Start() const { return start; }
 };
\ No newline at end of file
@@ -1,11 +1,15 @@
 /// @file NFABuilder.hpp
 /// @brief NFA builder class
 
+#include "CharClass.hpp"
 #include "NFA.hpp"
 #include "PreProcessor.hpp"
 #include "Regex.hpp"
 
 #include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <utility>
 #include <vector>
 #include <stack>
 
@@ -43,20 +47,53 @@ public:
     static NFA Build(const std::vector<Regex::Flat::Type>& exprs);
 
 private:
+    /// @brief a hole is a transition waiting to be filled, named by the index of
+    ///        its state (high half) and its index in the state's transitions (low half)
+    static constexpr size_t HOLE_SLOT_BITS = sizeof(size_t) * 4;
+
+    /// @brief marks the end of a patch list
+    static constexpr size_t NO_HOLE = std::numeric_limits<size_t>::max();
+
     /// @brief struct representing a fragment. a fragment has an index, but
     ///        has transitions that are waiting to be filled
     struct Fragment
     {
-        /// @brief struct representing a fragment's hole (to be patched)
-        struct Hole
+        /// @brief list of a fragment's holes (to be patched), threaded through the
+        ///        holes themselves: until a hole is patched, its destination is the
+        ///        next hole of the list. Lists are spliced in O(1), and are move-only
+        ///        so a hole is only ever patched through one fragment
+        struct PatchList
         {
-            size_t holeIndex; ///< index of the state needing a transition
-            char tVal; ///< known transition value from holeIndex 
+            size_t head = NO_HOLE; ///< first hole of the list
+            size_t tail = NO_HOLE; ///< last hole of the list
+
+            PatchList() = default;
+            PatchList(size_t head, size_t tail) : head(head), tail(tail) { }
+            PatchList(PatchList&& other) noexcept
+                : head(std::exchange(other.head, NO_HOLE)), tail(std::exchange(other.tail, NO_HOLE)) { }
+            PatchList& operator=(PatchList&& other) noexcept
+            {
+                head = std::exchange(other.head, NO_HOLE);
+                tail = std::exchange(other.tail, NO_HOLE);
+                return *this;
+            }
+
+            bool Empty() const { return head == NO_HOLE; }
         };
         size_t startIndex; ///< index of the starting state in this fragment 
-        std::vector<Hole> holes; ///< transitions to be patched
+        PatchList holes; ///< transitions to be patched
     };
 
+    /// @brief stack of fragments, allocated with the nfa states
+    using FragmentStack = std::stack<Fragment, std::pmr::vector<Fragment>>;
+
+    /// @brief method to create an empty nfa, whose states and transitions (and the
+    ///        fragment stacks used to build it) are allocated from one arena
+    /// @param maxStates the (estimated) maximum number of states of the nfa
+    /// @param numCases the number of cases of the nfa
+    /// @return the nfa, with room reserved for maxStates states
+    static NFA NewNFA(size_t maxStates, size_t numCases);
+
     /// @brief Method to build a nearly completed (untagged) NFA fragment from an RE
     /// @tparam It the iteration method 
     /// @param[in] expr the expression to build from
@@ -64,15 +101,38 @@ private:
     /// @return the nearly completed NFA fragment to be finalized.
     template <Regex::ItOrder It>
     static Fragment BuildFragment(const Regex::Flat::Type& expr, 
-        std::vector<NFA::State>& states);
+        std::pmr::vector<NFA::State>& states);
 
     
     /// @brief method to patch a fragment's holes (in the state vector)
-    /// @param holes the vector of holes to patch
+    /// @param holes the list of holes to patch
     /// @param patchIndex the index of the state to patch the holes with
     /// @param nfaStates the vector of nfa states
-    static void PatchHoles(const std::vector<Fragment::Hole>& holes,
-        size_t patchIndex, std::vector<NFA::State>& nfaStates);
+    static void PatchHoles(Fragment::PatchList&& holes,
+        size_t patchIndex, std::pmr::vector<NFA::State>& nfaStates);
+
+    /// @brief method to add a transition waiting to be filled to a state
+    /// @param stateIndex the index of the state
+    /// @param lo the lowest symbol of the transition
+    /// @param hi the highest symbol of the transition
+    /// @param nfaStates the vector of nfa states
+    /// @return the list holding just the new hole
+    static Fragment::PatchList NewHole(size_t stateIndex, char lo, char hi,
+        std::pmr::vector<NFA::State>& nfaStates);
+
+    /// @brief method to join two lists of holes, in O(1)
+    /// @param left the list to come first
+    /// @param right the list to come second
+    /// @param nfaStates the vector of nfa states
+    /// @return the holes of left, followed by those of right
+    static Fragment::PatchList Splice(Fragment::PatchList&& left, Fragment::PatchList&& right,
+        std::pmr::vector<NFA::State>& nfaStates);
+
+    /// @brief method to get the transition of a hole
+    /// @param hole the hole
+    /// @param nfaStates the vector of nfa states
+    /// @return the transition waiting to be filled
+    static NFA::Transition& TransitionOf(size_t hole, std::pmr::vector<NFA::State>& nfaStates);
 
     /// @brief method to create a new state with a case tag and add it to
     ///        the state vector
@@ -80,20 +140,20 @@ private:
     /// @param caseNo the case number to tag the state with
     /// @param estTCount the estimated number of transitions out of this state
     /// @return the index of the new state added (previous size of the array)
-    static size_t NewState(std::vector<NFA::State>& nfaStates, size_t caseNo, size_t estTCount);
+    static size_t NewState(std::pmr::vector<NFA::State>& nfaStates, size_t caseNo, size_t estTCount);
 
     /// @brief method to create a new state without a case tag and add it to
     ///        the nfa state vector
     /// @param nfaStates the state vector to add the new state to
     /// @param estTCount the case number to 
     /// @return the index of the new state added (previous size of the array)
-    static size_t NewState(std::vector<NFA::State>& nfaStates, size_t estTCount);
+    static size_t NewState(std::pmr::vector<NFA::State>& nfaStates, size_t estTCount);
 
     /// @brief method to create a character fragment
     /// @param a the transition (character) value
     /// @param nfaStates the state vector of the current nfa
     /// @return the constructed fragment
-    static Fragment MakeChar(char a, std::vector<NFA::State>& nfaStates);
+    static Fragment MakeChar(char a, std::pmr::vector<NFA::State>& nfaStates);
 
     /// @brief method to create a set/range of characters to transition from
     /// @param lo the low end of the range
@@ -101,58 +161,65 @@ private:
     /// @param inverted if the range is to be inverted (\Sigma - S)
     /// @param nfaStates the nfa states
     /// @return the constructed fragment 
-    static Fragment MakeCharset(char lo, char hi, bool inverted, std::vector<NFA::State>& nfaStates);
+    static Fragment MakeCharset(char lo, char hi, bool inverted, std::pmr::vector<NFA::State>& nfaStates);
+
+    /// @brief method to create a class fragment, with one range transition per
+    ///        run of consecutive bytes in the class
+    /// @param charClass the class
+    /// @param nfaStates the nfa states
+    /// @return the constructed fragment
+    static Fragment MakeClass(const CharClass& charClass, std::pmr::vector<NFA::State>& nfaStates);
 
     /// @brief method to create a literal/string fragment
     /// @param string the string to create the fragment from 
     /// @param nfaStates the nfa states
     /// @return the constructed fragment 
-    static Fragment MakeLiteral(std::string_view string, std::vector<NFA::State>& nfaStates);
+    static Fragment MakeLiteral(std::string_view string, std::pmr::vector<NFA::State>& nfaStates);
 
     /// @brief method to apply a concatination operator to two fragments
     /// @param left the left fragment 
     /// @param right the right fragment
     /// @param nfaStates
     /// @return the concatination of left->right
-    static Fragment ApplyCat(const Fragment& left, const Fragment& right,
-        std::vector<NFA::State>& nfaStates);
+    static Fragment ApplyCat(Fragment&& left, Fragment&& right,
+        std::pmr::vector<NFA::State>& nfaStates);
 
     /// @brief method to apply a union operator to two fragments
     /// @param left the left fragment
     /// @param right the right fragment
     /// @param nfaStates the vector of nfa states
     /// @return the constructed fragment
-    static Fragment ApplyUnion(const Fragment& left, const Fragment& right,
-        std::vector<NFA::State>& nfaStates);
+    static Fragment ApplyUnion(Fragment&& left, Fragment&& right,
+        std::pmr::vector<NFA::State>& nfaStates);
     
     /// @brief method to apply a kleene star operator to a fragment
     /// @param fragment the fragment
     /// @param nfaStates the vector of nfa states
     /// @return the constructed fragment
-    static Fragment ApplyKStar(const Fragment& fragment, 
-        std::vector<NFA::State>& nfaStates);
+    static Fragment ApplyKStar(Fragment&& fragment, 
+        std::pmr::vector<NFA::State>& nfaStates);
 
     /// @brief method to apply a kleene plus operator to a fragment
     /// @param fragment the fragment
     /// @param nfaStates the vector of nfa states
     /// @return the constructed fragment
-    static Fragment ApplyKPlus(const Fragment& fragment,
-        std::vector<NFA::State>& nfaStates);
+    static Fragment ApplyKPlus(Fragment&& fragment,
+        std::pmr::vector<NFA::State>& nfaStates);
 
-    static Fragment ApplyKOpt(const Fragment& fragment,
-        std::vector<NFA::State>& nfaStates);
+    static Fragment ApplyKOpt(Fragment&& fragment,
+        std::pmr::vector<NFA::State>& nfaStates);
 
-    static Fragment ApplyOperator(PreProcessor::Operator_t op, std::stack<Fragment>& fragStack,
-        std::vector<NFA::State>& nfaStates);
+    static Fragment ApplyOperator(PreProcessor::Operator_t op, FragmentStack& fragStack,
+        std::pmr::vector<NFA::State>& nfaStates);
 
     static void BuildFragment(const RuleCase& pattern, 
-        std::vector<NFA::State>& nfaStates, Fragment& fragment);
+        std::pmr::vector<NFA::State>& nfaStates, Fragment& fragment);
 
-    static size_t ConcludeCase(size_t ruleNo, Fragment& ruleFragment, 
-        std::vector<NFA::State>& nfaStates, 
+    static size_t ConcludeCase(size_t ruleNo, Fragment&& ruleFragment, 
+        std::pmr::vector<NFA::State>& nfaStates, 
         std::unordered_set<size_t>& nfaAccepting);
 
-    static void ShuntingYard(const RuleCase& pattern, Fragment& fragment,  std::vector<NFA::State>& nfaStates);
+    static void ShuntingYard(const RuleCase& pattern, Fragment& fragment,  std::pmr::vector<NFA::State>& nfaStates);
 
 
 
@@ -162,8 +229,6 @@ private:
     /// -----------------------------------------------------------------------
     ///  Debug functions (to be removed)
     /// -----------------------------------------------------------------------
-    #warning debug functions are enabled
-
     static void Debug(const Fragment& frag);
 
 };
\ No newline at end of file
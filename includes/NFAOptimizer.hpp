@@ -0,0 +1,35 @@
+/// @file NFAOptimizer.hpp
+/// @brief Provides the declarations for the NFAOptimizer class, which shrinks
+///        constructed nfas
+
+#pragma once
+
+#include "NFA.hpp"
+
+/// @brief static class of passes over constructed nfas
+class NFAOptimizer
+{
+public:
+    /// -----------------------------------------------------------------------
+    /// Explicitly delete constructors, destructor and operator=
+    /// -----------------------------------------------------------------------
+    NFAOptimizer() = delete;
+    ~NFAOptimizer() = delete;
+    NFAOptimizer(const NFAOptimizer&) = delete;
+    NFAOptimizer(const NFAOptimizer&&) = delete;
+    NFAOptimizer& operator=(const NFAOptimizer&) = delete;
+    NFAOptimizer& operator=(const NFAOptimizer&&) = delete;
+
+    /// -----------------------------------------------------------------------
+    /// Public api methods
+    /// -----------------------------------------------------------------------
+
+    /// @brief build an equivalent epsilon-free nfa. Each state takes over the
+    ///        symbol transitions and the (lowest) case tag of its epsilon closure,
+    ///        states with the same tag and transitions are merged, and states
+    ///        unreachable from the start are dropped. The result matches the same
+    ///        language per case, and determinizes to an equivalent dfa
+    /// @param nfa the nfa to optimize
+    /// @return the optimized nfa
+    static NFA RemoveEpsilons(const NFA& nfa);
+};
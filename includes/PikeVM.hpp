@@ -0,0 +1,86 @@
+/// @file PikeVM.hpp
+/// @brief Provides the declarations for the PikeVM class, which matches with an
+///        nfa directly, without constructing a dfa
+
+#pragma once
+
+#include "CompactNFA.hpp"
+#include "Scanner.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+struct NFA;
+
+/// @brief Thompson nfa simulation. The set of live nfa states is advanced a byte at a
+///        time, following epsilon edges as states are added, so a state is visited at
+///        most once per byte. A match takes O(input * (states + edges)) time and
+///        O(states) memory besides the nfa, however large the equivalent dfa would be.
+///        Produces the same tokens as a Scanner over the dfa of the nfa. Nothing is
+///        allocated once the vm is constructed
+class PikeVM
+{
+public:
+    /// @brief prepare an nfa for simulation
+    /// @param nfa the nfa, only used during construction
+    PikeVM(const NFA& nfa);
+
+    /// @brief prepare a compact nfa for simulation
+    /// @param nfa the nfa, copied into the vm
+    PikeVM(const CompactNFA& nfa);
+
+    /// @brief prepare a compact nfa for simulation
+    /// @param nfa the nfa, moved into the vm
+    PikeVM(CompactNFA&& nfa);
+
+    /// @brief find the longest match starting at an offset of the input, ties going
+    ///        to the lowest numbered case. When no case matches a (non-empty) prefix,
+    ///        a single byte token tagged NO_CASE_TAG is produced
+    /// @param input the input
+    /// @param offset the offset of the token, less than the input size
+    /// @return the token
+    Token MunchAt(std::string_view input, size_t offset);
+
+    /// @brief tokenize a whole input
+    /// @param input the input
+    /// @return every token of the input
+    std::vector<Token> Tokenize(std::string_view input);
+
+    /// @brief get the number of nfa states simulated
+    size_t NumStates() const;
+
+private:
+    /// @brief set of states with O(1) insert, membership and clear, iterated in
+    ///        insertion order
+    struct SparseSet
+    {
+        std::vector<uint32_t> dense; ///< the members, in insertion order
+        std::vector<uint32_t> sparse; ///< index of each state in dense
+        size_t size; ///< the number of members
+
+        bool Contains(uint32_t state) const
+        {
+            return sparse[state] < size && dense[sparse[state]] == state;
+        }
+
+        void Insert(uint32_t state)
+        {
+            sparse[state] = static_cast<uint32_t>(size);
+            dense[size++] = state;
+        }
+    };
+
+    /// @brief add the epsilon closure of a state to a set, following the epsilon
+    ///        edges of the states not in the set yet
+    /// @param set the set
+    /// @param state the state
+    /// @param[in,out] tag the lowest case tag accepted by the set
+    void AddClosure(SparseSet& set, uint32_t state, uint32_t& tag);
+
+    CompactNFA nfa_; ///< the nfa simulated
+    std::vector<uint32_t> stack_; ///< states whose epsilon edges are yet to be followed
+    SparseSet current_; ///< the live states
+    SparseSet next_; ///< the states live after the next byte
+};
@@ -3,13 +3,20 @@
 
 #pragma once
 
+#include "CharClass.hpp"
+#include "LexerUtil/Constants.hpp"
+
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 struct RuleCase;
 
-/// @brief static class to process regular expressions into NFAs
+/// @brief static class to process regular expressions into NFAs. The syntax of a
+///        pattern is defined here alone: the processing is constexpr, so the same
+///        code reads the patterns of StaticDFABuilder at compile time
 class PreProcessor
 {
 public:
@@ -36,6 +43,11 @@ public:
     /// @param patterns the patterns to pre-process
     static void PreProcess(std::vector<RuleCase>& patterns);
 
+    /// @brief method to preprocess a regex pattern (see PreProcess). Usable in a
+    ///        constant evaluation, where an invalid pattern fails the compilation
+    /// @param pattern the pattern to modify
+    static constexpr void PreProcessRegex(std::string& pattern);
+
     /// @brief enum class representing the publicly available operators, where
     ///        their values represent their operator precidence (other than LPAREN RPAREN)
     enum class Operator_t : uint32_t
@@ -49,24 +61,58 @@ public:
         RPAREN = 6
     };
 
-    static bool IsOperator(char c);
-    static Operator_t OperatorOf(char c);
-    static uint32_t PriorityOf(Operator_t op);
-    static bool isBinary(Operator_t op);
+    /// @brief number of characters of a class in a preprocessed pattern. Every
+    ///        bracket expression and shorthand (\d \w \s \D \W \S) is preprocessed
+    ///        into a single class: a marker followed by the bytes of its bitmap
+    static constexpr size_t CLASS_SIZE = 1 + sizeof(CharClass::bits);
+
+    /// @brief check if a character of a preprocessed pattern starts a class
+    /// @param c the character to check
+    /// @return true if c starts a class
+    static constexpr bool IsClass(char c);
+
+    /// @brief get a class of a preprocessed pattern
+    /// @param pattern the preprocessed pattern
+    /// @param offset the offset of the start of the class (see IsClass)
+    /// @return the class, which spans CLASS_SIZE characters from offset
+    static constexpr CharClass ClassAt(std::string_view pattern, size_t offset);
+
+    static constexpr bool IsOperator(char c);
+    static constexpr Operator_t OperatorOf(char c);
+    static constexpr uint32_t PriorityOf(Operator_t op);
+    static constexpr bool isBinary(Operator_t op);
 
 private:
 
+    /// @brief method to report an invalid pattern. It is not constexpr, so reaching
+    ///        it in a constant evaluation is a compile error naming the check failed
+    /// @param message what is wrong with the pattern
+    /// @param pattern the pattern, if any
+    [[noreturn]] static void Invalid(std::string_view message, std::string_view pattern = { });
+
     /// -----------------------------------------------------------------------
     /// Pre-Processing functions
     /// -----------------------------------------------------------------------
 
-    /// @brief function to process a pattern's range operators
-    /// @param pattern the pattern to modify
-    static void UnifyRanges(std::string& pattern);
+    /// @brief function to compile a bracket expression into a class
+    /// @param pattern the (unencoded) pattern
+    /// @param[in,out] i the offset of the '[', set to the offset of the closing ']'
+    /// @return the class of the bracket expression
+    static constexpr CharClass CompileClass(std::string_view pattern, size_t& i);
+
+    /// @brief function to get the class of a shorthand escape
+    /// @param c the character after the '\'
+    /// @return the class, or nullopt if c does not name a shorthand
+    static constexpr std::optional<CharClass> ShorthandOf(char c);
+
+    /// @brief function to write a class into an encoded pattern (see CLASS_SIZE)
+    /// @param pattern the encoded pattern to append to
+    /// @param charClass the class
+    static constexpr void AppendClass(std::string& pattern, const CharClass& charClass);
 
     /// @brief function to insert concatination operators 
     /// @param pattern the pattern to modify
-    static void InsertConcats(std::string& pattern);
+    static constexpr void InsertConcats(std::string& pattern);
 
     /// @brief method to convert a regex pattern to RPN
     /// @param pattern the pattern to change
@@ -95,7 +141,7 @@ private:
     /// @brief Decode a character, treating it as a literal no matter what
     /// @param c the character to decode
     /// @return the decoded character
-    static char Decode(char c);
+    static constexpr char Decode(char c);
 
     /// @brief enum class to represent encoded operators 
     enum class OpEncoded : char
@@ -116,11 +162,11 @@ private:
     /// @brief Encode the operators in the pattern to their encoded values
     /// @param op the operator to encode
     /// @return the encoded operator
-    static OpEncoded EncodeOp(OpDecoded op);
+    static constexpr OpEncoded EncodeOp(OpDecoded op);
 
     /// @brief encode a pattern's operators to their encoded values
     /// @param pattern the pattern to encode
-    static void Encode(std::string& pattern);
+    static constexpr void Encode(std::string& pattern);
 
     /// @brief enum class to represent different "classes" of characeters
     enum class SymbolClass : uint32_t
@@ -134,12 +180,11 @@ private:
     };
     
     /// @brief method to return the type of a character in a regex
-    /// @tparam which operator type to use to check. 
-    ///         Instantiated explicitly with encoded and decoded op enum types
+    /// @tparam which operator type to use to check (encoded or decoded op enum type)
     /// @param c the character to check
     /// @return the type of the character
     template <typename Operator_t>
-    static SymbolClass GetType(char c);
+    static constexpr SymbolClass GetType(char c);
 
     /// -----------------------------------------------------------------------
     /// Pre-Processing functions
@@ -147,4 +192,317 @@ private:
 
     static void PrintRegex(std::ostream& os, std::string_view pattern);
     static std::string RegexStr(std::string_view pattern);
-};
\ No newline at end of file
+};
+/// ---------------------------------------------------------------------------
+/// Constexpr definitions
+/// ---------------------------------------------------------------------------
+
+constexpr void PreProcessor::PreProcessRegex(std::string& pattern)
+{
+    Encode(pattern);
+    InsertConcats(pattern);
+}
+
+constexpr bool PreProcessor::IsClass(char c)
+{
+    return c == (char)OpEncoded::LBRACE;
+}
+
+constexpr CharClass PreProcessor::ClassAt(std::string_view pattern, size_t offset)
+{
+    if (offset + CLASS_SIZE > pattern.size() || !IsClass(pattern[offset]))
+    {
+        Invalid("Expected a class");
+    }
+
+    CharClass ret{ };
+    for (size_t byteI = 0; byteI < sizeof(ret.bits); ++byteI)
+    {
+        const uint64_t byte = static_cast<uint8_t>(pattern[offset + 1 + byteI]);
+        ret.bits[byteI / 8] |= (byte << (8 * (byteI % 8)));
+    }
+    return ret;
+}
+
+constexpr bool PreProcessor::IsOperator(char c)
+{
+    char decoded = Decode(c);
+    return (decoded != c);
+}
+
+constexpr auto PreProcessor::OperatorOf(char c) -> Operator_t
+{
+    switch((OpEncoded) c)
+    {
+        case OpEncoded::UNION: return Operator_t::UNION;
+        case OpEncoded::CONCAT: return Operator_t::CONCAT;
+        case OpEncoded::KLEENE: return Operator_t::KSTAR;
+        case OpEncoded::PLUS: return Operator_t::KPLUS;
+        case OpEncoded::OPTIONAL: return Operator_t::OPTIONAL;
+        case OpEncoded::LPAREN: return Operator_t::LPAREN;
+        case OpEncoded::RPAREN: return Operator_t::RPAREN;
+        default: break;
+    }
+
+    Invalid("Invalid operator requested");
+}
+
+constexpr uint32_t PreProcessor::PriorityOf(Operator_t op)
+{
+    switch( op )
+    {
+    case Operator_t::UNION: return 0;
+    case Operator_t::CONCAT: return 1;
+    
+    case Operator_t::KSTAR:
+    case Operator_t::KPLUS: 
+    case Operator_t::OPTIONAL: 
+    {
+        return 2;
+    }
+    case Operator_t::LPAREN: return 3;
+    case Operator_t::RPAREN: return 4;
+    default: return -1;
+    }
+}
+
+constexpr bool PreProcessor::isBinary(Operator_t op)
+{
+    switch( op )
+    {
+    case Operator_t::KSTAR:
+    case Operator_t::KPLUS:
+    case Operator_t::OPTIONAL:
+    {
+        return true;
+    }    
+    default: 
+    {
+        return false;
+    }
+    }
+}
+
+template <typename Operator_t>
+constexpr auto PreProcessor::GetType(char c) -> SymbolClass
+{  
+    switch(( (Operator_t) c))
+    {
+    case Operator_t::UNION:
+    case Operator_t::CONCAT:
+        return SymbolClass::BINARY_OP;
+
+    case Operator_t::KLEENE:
+    case Operator_t::PLUS:
+    case Operator_t::OPTIONAL:
+        return SymbolClass::UNARY_OP;
+
+    case Operator_t::LPAREN: return SymbolClass::LPAREN;
+    case Operator_t::RPAREN: return SymbolClass::RPAREN;
+    
+    case Operator_t::LBRACE:
+    case Operator_t::RBRACE:
+    case Operator_t::INVERT:
+    case Operator_t::RANGE_MID:
+        return SymbolClass::RANGE_OP;
+    
+    default: return SymbolClass::LITERAL; // if not an operator, then it's a literal
+    }
+}
+
+constexpr auto PreProcessor::EncodeOp(OpDecoded op) -> OpEncoded
+{
+    switch(op) 
+    {
+    case OpDecoded::UNION:     return OpEncoded::UNION;
+    case OpDecoded::CONCAT:    return OpEncoded::CONCAT;
+    case OpDecoded::KLEENE:    return OpEncoded::KLEENE;
+    case OpDecoded::PLUS:      return OpEncoded::PLUS;
+    case OpDecoded::OPTIONAL:  return OpEncoded::OPTIONAL;
+    case OpDecoded::LPAREN:    return OpEncoded::LPAREN;
+    case OpDecoded::RPAREN:    return OpEncoded::RPAREN;
+    case OpDecoded::LBRACE:    return OpEncoded::LBRACE;
+    case OpDecoded::RBRACE:    return OpEncoded::RBRACE;
+    case OpDecoded::INVERT:    return OpEncoded::INVERT;
+    case OpDecoded::RANGE_MID: return OpEncoded::RANGE_MID;
+    default: Invalid("TODO: UNKERR?");
+    }
+}
+
+constexpr char PreProcessor::Decode(char c)
+{
+    switch( (OpEncoded) c )
+    {
+        case OpEncoded::UNION:     return (char)OpDecoded::UNION;
+        case OpEncoded::CONCAT:    return (char)OpDecoded::CONCAT;
+        case OpEncoded::KLEENE:    return (char)OpDecoded::KLEENE;
+        case OpEncoded::PLUS:      return (char)OpDecoded::PLUS;
+        case OpEncoded::OPTIONAL:  return (char)OpDecoded::OPTIONAL;
+        case OpEncoded::LPAREN:    return (char)OpDecoded::LPAREN;
+        case OpEncoded::RPAREN:    return (char)OpDecoded::RPAREN;
+        case OpEncoded::LBRACE:    return (char)OpDecoded::LBRACE;
+        case OpEncoded::RBRACE:    return (char)OpDecoded::RBRACE;
+        case OpEncoded::INVERT:    return (char)OpDecoded::INVERT;
+        case OpEncoded::RANGE_MID: return (char)OpDecoded::RANGE_MID;
+        default: return c;
+    }
+}
+
+constexpr std::optional<CharClass> PreProcessor::ShorthandOf(char c)
+{
+    switch ( c )
+    {
+    case 'd': return CharClasses::DIGIT;
+    case 'w': return CharClasses::WORD;
+    case 's': return CharClasses::SPACE;
+    case 'D': return CharClasses::DIGIT.NegatedIn(ALPHABET_CLASS);
+    case 'W': return CharClasses::WORD.NegatedIn(ALPHABET_CLASS);
+    case 'S': return CharClasses::SPACE.NegatedIn(ALPHABET_CLASS);
+    default: return std::nullopt;
+    }
+}
+
+constexpr void PreProcessor::Encode(std::string &pattern)
+{
+    std::string ret;
+    ret.reserve(pattern.size());
+
+    for (size_t i=0;i<pattern.size();++i) 
+    {
+        if (pattern[i] == '\\') 
+        {
+            i += 1; // advance to skip the next char (which is escaped)
+            if (i == pattern.size()) Invalid("Unmatched '\\'", pattern); // unmatched '\'
+            if (std::optional<CharClass> shorthand = ShorthandOf(pattern[i]))
+            {
+                AppendClass(ret, *shorthand);
+            }
+            else
+            {
+                ret.push_back(pattern[i]); // add the escaped char as a literal
+            }
+        }
+        else if (pattern[i] == (char)OpDecoded::LBRACE)
+        {
+            AppendClass(ret, CompileClass(pattern, i));
+        }
+        else if (pattern[i] == (char)OpDecoded::RBRACE)
+        {
+            Invalid("Unmatched ]", pattern);
+        }
+        else if (GetType<OpDecoded>(pattern[i]) != SymbolClass::LITERAL) 
+        {
+            ret.push_back((char) EncodeOp((OpDecoded) pattern[i]));
+        }
+        else 
+        {
+            ret.push_back(pattern[i]);
+        }
+    }
+
+    pattern = std::move(ret);   
+}
+
+constexpr CharClass PreProcessor::CompileClass(std::string_view pattern, size_t &i)
+{
+    size_t j = i + 1;
+
+    /// read one member of the class, resolving its escape. A shorthand member
+    /// is written to shorthand instead
+    ///
+    auto ReadMember = [&](CharClass& shorthand) -> std::optional<uint8_t>
+    {
+        if (pattern[j] != '\\') return static_cast<uint8_t>(pattern[j++]);
+
+        if (j + 1 == pattern.size()) Invalid("Unmatched '\\'", pattern);
+        const char escaped = pattern[j + 1];
+        j += 2;
+        if (std::optional<CharClass> found = ShorthandOf(escaped))
+        {
+            shorthand = *found;
+            return std::nullopt;
+        }
+        return static_cast<uint8_t>(escaped);
+    };
+
+    const bool inverted = (j < pattern.size() && pattern[j] == (char)OpDecoded::INVERT);
+    if (inverted) ++j;
+
+    CharClass ret{ };
+    bool empty = true;
+    while (j < pattern.size() && pattern[j] != (char)OpDecoded::RBRACE)
+    {
+        empty = false;
+        CharClass shorthand{ };
+        std::optional<uint8_t> lo = ReadMember(shorthand);
+        if (!lo)
+        {
+            ret = ret | shorthand;
+            continue;
+        }
+
+        /// a '-' between two members makes a range, anywhere else it is literal
+        ///
+        if (j + 1 < pattern.size() && pattern[j] == (char)OpDecoded::RANGE_MID 
+            && pattern[j + 1] != (char)OpDecoded::RBRACE)
+        {
+            ++j;
+            std::optional<uint8_t> hi = ReadMember(shorthand);
+            if (!hi || *lo > *hi) Invalid("Invalid range", pattern);
+            ret.InsertRange(*lo, *hi);
+        }
+        else
+        {
+            ret.Insert(*lo);
+        }
+    }
+    if (j == pattern.size()) Invalid("Unmatched [", pattern);
+    if (empty) Invalid("Empty []", pattern);
+
+    i = j;
+    return (inverted ? ret.NegatedIn(ALPHABET_CLASS) : ret);
+}
+
+constexpr void PreProcessor::AppendClass(std::string &pattern, const CharClass &charClass)
+{
+    pattern.push_back((char)OpEncoded::LBRACE);
+    for (uint64_t word : charClass.bits)
+    {
+        for (size_t shift = 0; shift < 64; shift += 8)
+        {
+            pattern.push_back(static_cast<char>(word >> shift));
+        }
+    }
+}
+
+constexpr void PreProcessor::InsertConcats(std::string &pattern)
+{
+    std::string ret;
+    ret.reserve(2 * pattern.size());
+
+    /// a class is a single operand, so it is copied whole and its ranges are
+    /// never looked at
+    ///
+    SymbolClass left = SymbolClass::BINARY_OP; /// nothing to concatenate to yet
+    for (size_t i = 0; i < pattern.size();++i)
+    {
+        SymbolClass right = (IsClass(pattern[i]) ? SymbolClass::LITERAL : GetType<OpEncoded>(pattern[i]));
+        if ( (left == SymbolClass::LITERAL || left == SymbolClass::UNARY_OP || left == SymbolClass::RPAREN) &&
+             (right == SymbolClass::LITERAL || right == SymbolClass::LPAREN) )
+        {
+            ret.push_back((char)OpEncoded::CONCAT);
+        }
+
+        if (IsClass(pattern[i]))
+        {
+            ret.append(pattern, i, CLASS_SIZE);
+            i += CLASS_SIZE - 1;
+        }
+        else
+        {
+            ret.push_back(pattern[i]);
+        }
+        left = right;
+    }
+    pattern = std::move(ret);
+}
@@ -0,0 +1,106 @@
+/// @file Prefilter.hpp
+/// @brief Provides the declarations for the Prefilter class, which finds the
+///        literals every match of a rule set must contain, and searches text
+///        for them ahead of the dfa
+
+#pragma once
+
+#include "CharClass.hpp"
+#include "Regex.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct RuleCase;
+
+/// @brief multi-literal prefilter for unanchored search. Every match of every rule
+///        contains one of the literals, starting at most MaxOffset() bytes into the
+///        match, so no match can start more than MaxOffset() bytes before the next
+///        literal occurrence, and none at all past the last one
+class Prefilter
+{
+public:
+    /// @brief offset of a factor that may be arbitrarily far into a match
+    static constexpr size_t UNBOUNDED = std::numeric_limits<size_t>::max();
+
+    /// @brief maximum number of literals in a factor
+    static constexpr size_t MAX_LITERALS = 32;
+
+    /// @brief maximum length of a literal in a factor
+    static constexpr size_t MAX_LITERAL_LENGTH = 32;
+
+    /// @brief literals required by a regex: every match contains one of them,
+    ///        starting at most maxOffset bytes into the match
+    struct Factor
+    {
+        std::vector<std::string> literals; ///< the literals, none empty
+        size_t maxOffset; ///< the furthest offset of a literal in a match, or UNBOUNDED
+    };
+
+    /// @brief find the required factor of a rule case
+    /// @param ruleCase the rule case, not pre-processed
+    /// @return the factor, or nullopt if the rule has none (e.g. it can match
+    ///         the empty string, or too many different literals)
+    static std::optional<Factor> RequiredFactor(const RuleCase& ruleCase);
+
+    /// @brief find the required factor of a postorder flat regex
+    /// @param expr the expression
+    /// @return the factor, or nullopt if the expression has none
+    static std::optional<Factor> RequiredFactor(const Regex::Flat::Type& expr);
+
+    /// @brief build the prefilter of a rule set. No-match and end of file cases
+    ///        never match text, so they are left out
+    /// @param ruleCases the rule cases, not pre-processed
+    /// @return the prefilter, or nullopt if a rule has no required factor
+    static std::optional<Prefilter> Build(const std::vector<RuleCase>& ruleCases);
+
+    /// @brief create a prefilter from the factors of every rule
+    /// @param factors the factors
+    Prefilter(const std::vector<Factor>& factors);
+
+    /// @brief find the next occurrence of a literal
+    /// @param text the text to search
+    /// @param from the offset to search from
+    /// @return the offset of the first literal occurrence starting at or after
+    ///         from, or std::string_view::npos if there is none
+    size_t Find(std::string_view text, size_t from) const;
+
+    /// @brief the furthest offset of a literal in a match, or UNBOUNDED
+    size_t MaxOffset() const;
+
+    /// @brief the literals searched for
+    const std::vector<std::string>& Literals() const;
+
+private:
+    /// @brief what is known of the literals of a sub-expression
+    struct Info;
+
+    static Info Char(char c);
+    static Info Charset(char lo, char hi, bool inverted);
+    static Info Class(const CharClass& charClass);
+    static Info Literal(std::string_view string);
+    static Info Exact(std::vector<std::string> strings);
+    static Info Concat(const Info& left, const Info& right);
+    static Info Union(const Info& left, const Info& right);
+    static Info Star(const Info& info);
+    static Info Plus(const Info& info);
+    static Info Optional(const Info& info);
+
+    /// @brief pick the factor a search should use
+    /// @return true if a is the better factor
+    static bool Better(const Factor& a, const Factor& b);
+
+    std::vector<std::string> literals_; ///< the literals
+    size_t maxOffset_; ///< the furthest offset of a literal in a match
+    std::array<std::vector<uint32_t>, 256> byFirstByte_; ///< literals by their first byte
+    std::array<bool, 256> isFirstByte_; ///< if a literal starts with the byte
+    std::array<uint8_t, 4> lo_; ///< first bytes as ranges, for the vectorized search
+    std::array<uint8_t, 4> hi_; ///< first bytes as ranges, for the vectorized search
+    size_t numRanges_; ///< number of ranges, 0 if the first bytes need more than 4
+};
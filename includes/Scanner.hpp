@@ -0,0 +1,224 @@
+/// @file Scanner.hpp
+/// @brief Provides the declarations for the Scanner class, which tokenizes
+///        input with a constructed DFA
+
+#pragma once
+
+#include "DFA.hpp"
+#include "MappedFile.hpp"
+#include "LexerUtil/Simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief represents a token matched by a scanner
+struct Token
+{
+    size_t caseTag; ///< the case matched, NO_CASE_TAG if no case matched the input
+    size_t offset; ///< offset of the first byte of the token in the input
+    size_t length; ///< the number of bytes in the token
+};
+
+/// @brief maximal munch scanner. Every token is the longest prefix of the remaining
+///        input accepted by the dfa, ties going to the lowest numbered case. When no
+///        case matches a (non-empty) prefix, a single byte token tagged NO_CASE_TAG
+///        is produced, and scanning resumes after it
+class Scanner
+{
+public:
+    /// @brief create a scanner over an input buffer
+    /// @param dfa the dfa to scan with, must outlive the scanner
+    /// @param input the input to scan, must outlive the scanner
+    Scanner(const DFA& dfa, std::string_view input);
+
+    /// @brief create a scanner over an input buffer from the tables of a dfa
+    /// @param tables the tables to scan with, must outlive the scanner
+    /// @param input the input to scan, must outlive the scanner
+    Scanner(const DFA::Tables& tables, std::string_view input);
+
+    /// @brief scan the next token of the input
+    /// @param[out] token the token scanned
+    /// @return false if the input is exhausted (and no token was scanned)
+    bool Next(Token& token);
+
+    /// @brief get the text of a token scanned by this scanner
+    /// @param token the token
+    /// @return a view of the token in the input
+    std::string_view Lexeme(const Token& token) const;
+
+    /// @brief get the offset of the next byte to be scanned
+    size_t Offset() const;
+
+    /// @brief tokenize a whole buffer on several threads. The buffer is split into
+    ///        chunks, and each chunk is scanned speculatively as if a token started
+    ///        at its first byte. The chunks are then stitched in order: where the
+    ///        true token stream enters a chunk at an offset the speculative scan
+    ///        did not, tokens are rescanned until the two streams meet at a common
+    ///        token start, after which they are identical. The result is the same as
+    ///        scanning the buffer with Next
+    /// @param tables the tables to scan with
+    /// @param input the input to scan
+    /// @param numThreads the number of threads, 0 for one per hardware thread
+    /// @return every token of the input
+    static std::vector<Token> ScanParallel(const DFA::Tables& tables, std::string_view input,
+        size_t numThreads = 0);
+
+    /// @brief progress of a maximal munch, kept so a munch can be resumed on more input
+    struct Munch
+    {
+        uint32_t state; ///< the current dfa state
+        uint32_t tag; ///< packed case tag of the longest match so far
+        size_t length; ///< length of the longest match so far (0 if none)
+        size_t consumed; ///< number of bytes consumed so far
+    };
+
+    /// @brief create a munch at the start state of the dfa. The start state
+    ///        accepting is ignored, as a token can never be empty
+    static Munch Begin(const DFA::Tables& tables)
+    {
+        return Munch{ .state = tables.start, .tag = DFA::NO_TAG, .length = 0, .consumed = 0 };
+    }
+
+    /// @brief advance a munch over a run of input, until the dfa dies or the run ends
+    /// @param tables the tables of the dfa
+    /// @param munch the munch to advance
+    /// @param first the first byte of the run
+    /// @param last one past the last byte of the run
+    /// @return true if the dfa died (the munch is complete), false if the run ran out
+    static bool Advance(const DFA::Tables& tables, Munch& munch, const char* first, const char* last)
+    {
+        const uint8_t* const begin = reinterpret_cast<const uint8_t*>(first);
+        const uint8_t* const end = reinterpret_cast<const uint8_t*>(last);
+        const uint8_t* p = begin;
+        const size_t base = munch.consumed;
+        uint32_t state = munch.state;
+        uint32_t tag = munch.tag;
+        size_t length = munch.length;
+        bool died = false;
+
+        while (p != end)
+        {
+            const uint32_t from = state;
+            state = tables.table[state * tables.numClasses + tables.classes[*p++]];
+            if (state == tables.dead)
+            {
+                died = true;
+                break;
+            }
+
+            /// record the match without branching, accept states are hit often
+            ///
+            uint32_t stateTag = tables.tags[state];
+            bool accepting = (stateTag != DFA::NO_TAG);
+            tag = (accepting ? stateTag : tag);
+
+            /// once a self-loop is taken, the rest of its run is skipped at once
+            ///
+            if (state == from && tables.accels != nullptr && tables.accels[state].numRanges != 0)
+            {
+                const DFA::Accel& accel = tables.accels[state];
+                p = FindNotInRanges(p, end, accel.lo.data(), accel.hi.data(), accel.numRanges);
+            }
+            length = (accepting ? base + static_cast<size_t>(p - begin) : length);
+        }
+
+        munch = Munch{ .state = state, .tag = tag, .length = length,
+            .consumed = base + static_cast<size_t>(p - begin) };
+        return died;
+    }
+
+private:
+    /// @brief scan the token starting at an offset of the input
+    /// @param tables the tables to scan with
+    /// @param input the input
+    /// @param offset the offset of the token, less than the input size
+    /// @return the token
+    static Token MunchAt(const DFA::Tables& tables, std::string_view input, size_t offset);
+
+    DFA::Tables tables_; ///< the tables of the dfa scanned with
+    std::string_view input_; ///< the input being scanned
+    size_t offset_; ///< offset of the next byte to scan
+};
+
+/// @brief maximal munch scanner over a stream of caller supplied chunks. Produces
+///        the same tokens as a Scanner over the concatenated chunks, with token 
+///        offsets relative to the start of the stream. Only the bytes of the token
+///        in flight at a chunk boundary are buffered, so memory use does not
+///        depend on the size of the stream
+class StreamScanner
+{
+public:
+    /// @brief create a stream scanner
+    /// @param dfa the dfa to scan with, must outlive the scanner
+    StreamScanner(const DFA& dfa);
+
+    /// @brief create a stream scanner from the tables of a dfa
+    /// @param tables the tables to scan with, must outlive the scanner
+    StreamScanner(const DFA::Tables& tables);
+
+    /// @brief supply the next chunk of the stream. May only be called once every
+    ///        token of the previous chunk has been scanned (Next returned false)
+    /// @param chunk the next chunk, must stay valid until Next returns false
+    void Feed(std::string_view chunk);
+
+    /// @brief mark the end of the stream, so the token in flight can be completed
+    void Finish();
+
+    /// @brief scan the next token of the stream
+    /// @param[out] token the token scanned
+    /// @param[out] lexeme the text of the token, valid until the next call to Next
+    /// @return false if more input is needed (or the stream is exhausted)
+    bool Next(Token& token, std::string_view& lexeme);
+
+    /// @brief get the stream offset of the first byte not yet returned in a token
+    size_t Offset() const;
+
+private:
+    /// @brief release the bytes of the last returned token
+    void Drop();
+
+    DFA::Tables tables_; ///< the tables of the dfa scanned with
+    Scanner::Munch munch_; ///< the munch of the token in flight
+    std::string window_; ///< bytes of the token in flight from previous chunks
+    std::string_view chunk_; ///< the current chunk
+    size_t chunkOffset_; ///< the first byte of the chunk not yet moved to the window
+    size_t offset_; ///< stream offset of the token in flight
+    size_t dropLength_; ///< length of the last returned token, released on the next call
+    bool finished_; ///< if the end of the stream has been reached
+};
+
+/// @brief maximal munch scanner over a memory mapped file. The file is never copied,
+///        lexemes are views into the mapping, valid for as long as the scanner
+class FileScanner
+{
+public:
+    /// @brief map a file and create a scanner over it
+    /// @param dfa the dfa to scan with, must outlive the scanner
+    /// @param path the path of the file to scan
+    FileScanner(const DFA& dfa, const char* path);
+
+    /// @brief map a file and create a scanner over it from the tables of a dfa
+    /// @param tables the tables to scan with, must outlive the scanner
+    /// @param path the path of the file to scan
+    FileScanner(const DFA::Tables& tables, const char* path);
+
+    /// @brief scan the next token of the file
+    /// @param[out] token the token scanned
+    /// @return false if the file is exhausted (and no token was scanned)
+    bool Next(Token& token);
+
+    /// @brief get the text of a token scanned by this scanner
+    /// @param token the token
+    /// @return a view of the token in the mapping
+    std::string_view Lexeme(const Token& token) const;
+
+    /// @brief get a view of the whole mapped file
+    std::string_view Input() const;
+
+private:
+    MappedFile file_; ///< the mapped file, declared first to outlive the scanner
+    Scanner scanner_; ///< the scanner over the mapping
+};
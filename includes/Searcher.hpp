@@ -0,0 +1,52 @@
+/// @file Searcher.hpp
+/// @brief Provides the declarations for the Searcher class, which finds the
+///        occurrences of a rule set inside a text
+
+#pragma once
+
+#include "DFA.hpp"
+#include "Prefilter.hpp"
+#include "Scanner.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct RuleCase;
+
+/// @brief unanchored search with the dfa of a rule set. A match is the leftmost
+///        non-empty match in the text, and the longest one starting there (ties
+///        going to the lowest numbered case), as a Scanner started at that offset
+///        would produce. When every rule has a required literal factor, a
+///        prefilter skips the text between literal occurrences, and the dfa only
+///        runs near them
+class Searcher
+{
+public:
+    /// @brief build the dfa and prefilter of a rule set
+    /// @param ruleCases the rule cases, not pre-processed
+    Searcher(const std::vector<RuleCase>& ruleCases);
+
+    /// @brief find the first match starting at or after an offset
+    /// @param text the text to search
+    /// @param from the offset to search from
+    /// @param[out] match the match found, its offset relative to the text
+    /// @return false if there is no match
+    bool Find(std::string_view text, size_t from, Token& match) const;
+
+    /// @brief find every non-overlapping match of a text, from left to right
+    /// @param text the text to search
+    /// @return the matches
+    std::vector<Token> FindAll(std::string_view text) const;
+
+    /// @brief get the prefilter of the searcher, if the rules have one
+    const std::optional<Prefilter>& GetPrefilter() const;
+
+private:
+    /// @brief build the minimized dfa of a rule set
+    static DFA BuildDFA(const std::vector<RuleCase>& ruleCases);
+
+    DFA dfa_; ///< the dfa of the rule set
+    std::optional<Prefilter> prefilter_; ///< the prefilter, if every rule has a factor
+};
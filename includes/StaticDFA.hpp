@@ -0,0 +1,750 @@
+/// @file StaticDFA.hpp
+/// @brief Provides the StaticDFA and StaticDFABuilder classes, which construct a dfa
+///        from regex string literals at compile time
+
+#pragma once
+
+#include "CharClass.hpp"
+#include "DFA.hpp"
+#include "PreProcessor.hpp"
+#include "LexerUtil/Constants.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief string literal usable as a template argument
+template <size_t N>
+struct FixedString
+{
+    consteval FixedString(const char (&string)[N])
+    {
+        std::copy_n(string, N, data);
+    }
+
+    /// @brief get a view of the string, without the terminating null
+    constexpr std::string_view View() const
+    {
+        return std::string_view{ data, N - 1 };
+    }
+
+    char data[N];
+};
+
+/// @brief dfa whose tables are fixed size arrays, constructed at compile time by
+///        StaticDFABuilder. The table dimensions are part of the type, so the scan
+///        loop is specialized on them and nothing is constructed at startup
+/// @tparam NumStates the number of states of the dfa
+/// @tparam NumClasses the number of symbol classes (columns of the table)
+template <size_t NumStates, size_t NumClasses>
+class StaticDFA
+{
+public:
+    /// @brief the longest match of a dfa on an input
+    struct Match
+    {
+        uint32_t tag; ///< packed case tag of the match, DFA::NO_TAG if none
+        size_t length; ///< length of the match, 0 if none
+    };
+
+    constexpr size_t Start() const { return start_; }
+    constexpr size_t Dead() const { return dead_; }
+
+    /// @brief get the packed case tag of a state, DFA::NO_TAG if not accepting
+    constexpr uint32_t TagOf(size_t state) const { return tags_[state]; }
+
+    /// @brief get the state reached from a state upon reading a symbol
+    /// @param state the index of the state to transition from
+    /// @param symbol the symbol read
+    /// @return the index of the resulting state
+    constexpr size_t Next(size_t state, char symbol) const
+    {
+        return table_[state * NumClasses + classes_[static_cast<uint8_t>(symbol)]];
+    }
+
+    /// @brief find the longest non-empty prefix of an input accepted by the dfa,
+    ///        ties going to the lowest numbered case (as Scanner does)
+    /// @param input the input to match
+    /// @return the match, of length 0 if no prefix is accepted
+    constexpr Match LongestMatch(std::string_view input) const
+    {
+        Match match{ .tag = DFA::NO_TAG, .length = 0 };
+        uint32_t state = start_;
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            state = table_[state * NumClasses + classes_[static_cast<uint8_t>(input[i])]];
+            if (state == dead_) break;
+            if (tags_[state] != DFA::NO_TAG)
+            {
+                match = Match{ .tag = tags_[state], .length = i + 1 };
+            }
+        }
+        return match;
+    }
+
+    /// @brief get a view of the tables of the dfa, e.g. to run a Scanner with
+    DFA::Tables View() const
+    {
+        return DFA::Tables{
+            .table = table_.data(),
+            .classes = classes_.data(),
+            .tags = tags_.data(),
+            .accels = nullptr,
+            .numClasses = NumClasses,
+            .start = start_,
+            .dead = dead_
+        };
+    }
+
+private:
+    friend class StaticDFABuilder;
+
+    std::array<uint32_t, NumStates * NumClasses> table_{ }; ///< row-major transition table
+    DFA::ClassMap classes_{ }; ///< byte -> symbol class
+    std::array<uint32_t, NumStates> tags_{ }; ///< packed case tag of every state
+    uint32_t start_ = 0; ///< starting state index
+    uint32_t dead_ = 0; ///< dead state index
+};
+
+/// @brief static class to construct a StaticDFA from regex string literals at
+///        compile time. The patterns are preprocessed by PreProcessor and built
+///        into a thompson nfa as NFABuilder does, so they have the syntax and the
+///        meaning of REGEX rules, and case tags are the indices of the patterns.
+///        An invalid pattern fails the compilation
+///
+/// @example constexpr auto lexer = StaticDFABuilder::Build<"if", "[a-z][a-z0-9]*">();
+class StaticDFABuilder
+{
+public:
+    /// -----------------------------------------------------------------------
+    /// Explicitly delete constructors, destructor and operator=
+    /// -----------------------------------------------------------------------
+
+    StaticDFABuilder() = delete;
+    ~StaticDFABuilder() = delete;
+    StaticDFABuilder(const StaticDFABuilder&) = delete;
+    StaticDFABuilder(const StaticDFABuilder&&) = delete;
+    StaticDFABuilder& operator=(const StaticDFABuilder&) = delete;
+    StaticDFABuilder& operator=(const StaticDFABuilder&&) = delete;
+
+    /// -----------------------------------------------------------------------
+    /// Public api methods
+    /// -----------------------------------------------------------------------
+
+    /// @brief method to construct the minimal dfa of a set of patterns. The
+    ///        construction is run once to size the tables, and once to fill them
+    /// @tparam Patterns the patterns of the cases, in order
+    /// @return the dfa
+    template <FixedString... Patterns>
+    static consteval auto Build()
+    {
+        constexpr Sizes sizes = Measure({ Patterns.View()... });
+        StaticDFA<sizes.numStates, sizes.numClasses> ret;
+
+        const Tables tables = Construct({ Patterns.View()... });
+        std::copy(tables.table.begin(), tables.table.end(), ret.table_.begin());
+        std::copy(tables.tags.begin(), tables.tags.end(), ret.tags_.begin());
+        ret.classes_ = tables.classes;
+        ret.start_ = tables.start;
+        ret.dead_ = tables.dead;
+        return ret;
+    }
+
+private:
+    /// -----------------------------------------------------------------------
+    /// Constant evaluated construction types
+    /// -----------------------------------------------------------------------
+
+    /// @brief nfa state set, one bit per nfa state
+    using StateSet = std::vector<uint64_t>;
+
+    /// @brief index of the byte set labelling epsilon transitions
+    static constexpr size_t EPSILON_SET = static_cast<size_t>(-1);
+
+    struct Transition
+    {
+        size_t symbols; ///< index of the byte set read, EPSILON_SET for epsilon
+        size_t to; ///< the state transitioned to
+    };
+
+    struct NFA
+    {
+        std::vector<std::vector<Transition>> transitions; ///< transitions of every state
+        std::vector<uint32_t> tags; ///< packed case tag of every state
+        std::vector<CharClass> sets; ///< the byte sets labelling transitions
+        size_t start = 0;
+    };
+
+    struct Fragment
+    {
+        struct Hole
+        {
+            size_t state; ///< the state missing a transition
+            size_t symbols; ///< the byte set of the missing transition
+        };
+
+        size_t start;
+        std::vector<Hole> holes;
+    };
+
+    struct Sizes
+    {
+        size_t numStates;
+        size_t numClasses;
+    };
+
+    struct Tables
+    {
+        size_t numStates = 0;
+        size_t numClasses = 0;
+        DFA::ClassMap classes{ };
+        std::vector<uint32_t> table;
+        std::vector<uint32_t> tags;
+        uint32_t start = 0;
+        uint32_t dead = 0;
+    };
+
+    /// -----------------------------------------------------------------------
+    /// Pipeline methods
+    /// -----------------------------------------------------------------------
+
+    static constexpr Sizes Measure(std::initializer_list<std::string_view> patterns)
+    {
+        Tables tables = Construct(patterns);
+        return Sizes{ .numStates = tables.numStates, .numClasses = tables.numClasses };
+    }
+
+    /// @brief method to run the whole pipeline: preprocess each pattern, build the
+    ///        thompson nfa, run the powerset construction and minimize
+    static constexpr Tables Construct(std::initializer_list<std::string_view> patterns)
+    {
+        NFA nfa;
+        nfa.start = NewState(nfa, DFA::NO_TAG);
+
+        uint32_t caseTag = 0;
+        for (std::string_view pattern : patterns)
+        {
+            std::string encoded(pattern.begin(), pattern.end());
+            PreProcessor::PreProcessRegex(encoded);
+            Fragment fragment = ShuntingYard(encoded, nfa);
+            size_t accept = NewState(nfa, caseTag++);
+            PatchHoles(fragment, accept, nfa);
+            nfa.transitions[nfa.start].push_back(Transition{ EPSILON_SET, fragment.start });
+        }
+
+        return Minimize(Powerset(nfa));
+    }
+
+    /// -----------------------------------------------------------------------
+    /// Nfa methods (mirror NFABuilder)
+    /// -----------------------------------------------------------------------
+
+    static constexpr size_t NewState(NFA& nfa, uint32_t tag)
+    {
+        nfa.transitions.emplace_back();
+        nfa.tags.push_back(tag);
+        return nfa.tags.size() - 1;
+    }
+
+    static constexpr void PatchHoles(const Fragment& fragment, size_t state, NFA& nfa)
+    {
+        for (const Fragment::Hole& hole : fragment.holes)
+        {
+            nfa.transitions[hole.state].push_back(Transition{ hole.symbols, state });
+        }
+    }
+
+    /// @brief method to make the fragment of an operand. Transitions are clipped
+    ///        to the alphabet, as CompactNFA does
+    static constexpr Fragment MakeClass(const CharClass& charClass, NFA& nfa)
+    {
+        size_t q0 = NewState(nfa, DFA::NO_TAG);
+        nfa.sets.push_back(charClass & ALPHABET_CLASS);
+        return Fragment{ .start = q0, .holes = { { q0, nfa.sets.size() - 1 } } };
+    }
+
+    static constexpr void ApplyOperator(PreProcessor::Operator_t op, std::vector<Fragment>& fragments,
+        NFA& nfa)
+    {
+        using enum PreProcessor::Operator_t;
+
+        switch (op)
+        {
+        case KPLUS: throw std::invalid_argument("Unimplemented '+' operator");
+        case OPTIONAL: throw std::invalid_argument("Unimplemented '?' operator");
+        default: break;
+        }
+
+        size_t operands = (op == KSTAR ? 1 : 2);
+        if (fragments.size() < operands) throw std::invalid_argument("Missing operand");
+
+        if (op == KSTAR)
+        {
+            /// as NFABuilder::ApplyKStar, the star is left from the start of the
+            /// starred fragment
+            ///
+            Fragment& fragment = fragments.back();
+            const size_t starred = fragment.start;
+            size_t q0 = NewState(nfa, DFA::NO_TAG);
+            nfa.transitions[q0].push_back(Transition{ EPSILON_SET, starred });
+            PatchHoles(fragment, q0, nfa);
+            fragment = Fragment{ .start = q0, .holes = { { starred, EPSILON_SET } } };
+            return;
+        }
+
+        Fragment right = std::move(fragments.back());
+        fragments.pop_back();
+        Fragment& left = fragments.back();
+        if (op == CONCAT)
+        {
+            PatchHoles(left, right.start, nfa);
+            left.holes = std::move(right.holes);
+        }
+        else
+        {
+            size_t q0 = NewState(nfa, DFA::NO_TAG);
+            nfa.transitions[q0].push_back(Transition{ EPSILON_SET, left.start });
+            nfa.transitions[q0].push_back(Transition{ EPSILON_SET, right.start });
+            left.start = q0;
+            left.holes.insert(left.holes.end(), right.holes.begin(), right.holes.end());
+        }
+    }
+
+    /// @brief method to build the fragment of a preprocessed pattern with the
+    ///        shunting yard algorithm, as NFABuilder::ShuntingYard does
+    static constexpr Fragment ShuntingYard(std::string_view pattern, NFA& nfa)
+    {
+        using enum PreProcessor::Operator_t;
+
+        bool expectOperand = true;
+        std::vector<PreProcessor::Operator_t> ops;
+        std::vector<Fragment> fragments;
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            char c = pattern[i];
+            if (PreProcessor::IsClass(c))
+            {
+                if (!expectOperand) throw std::invalid_argument("Expected an operator, got a class");
+                fragments.push_back(MakeClass(PreProcessor::ClassAt(pattern, i), nfa));
+                i += PreProcessor::CLASS_SIZE - 1; /// skip to the end of the class
+                expectOperand = false;
+                continue;
+            }
+            if (!PreProcessor::IsOperator(c))
+            {
+                if (!expectOperand) throw std::invalid_argument("Expected an operator, got a literal");
+                fragments.push_back(MakeClass(CharClass::Range(static_cast<uint8_t>(c), static_cast<uint8_t>(c)), nfa));
+                expectOperand = false;
+                continue;
+            }
+
+            PreProcessor::Operator_t op = PreProcessor::OperatorOf(c);
+            switch (op)
+            {
+            case LPAREN:
+            {
+                ops.push_back(LPAREN);
+                expectOperand = true;
+                break;
+            }
+            case RPAREN:
+            {
+                if (expectOperand) throw std::invalid_argument("Unexpected ')'");
+                while (!ops.empty() && ops.back() != LPAREN)
+                {
+                    ApplyOperator(ops.back(), fragments, nfa);
+                    ops.pop_back();
+                }
+                if (ops.empty()) throw std::invalid_argument("Unmatched ')'");
+                ops.pop_back();
+                expectOperand = false;
+                break;
+            }
+            default:
+            {
+                if (expectOperand) throw std::invalid_argument("Unexpected operator");
+                while (!ops.empty() && ops.back() != LPAREN &&
+                    (PreProcessor::PriorityOf(ops.back()) > PreProcessor::PriorityOf(op) ||
+                     (PreProcessor::PriorityOf(ops.back()) == PreProcessor::PriorityOf(op)
+                        && PreProcessor::isBinary(op))))
+                {
+                    ApplyOperator(ops.back(), fragments, nfa);
+                    ops.pop_back();
+                }
+                ops.push_back(op);
+                expectOperand = !PreProcessor::isBinary(op);
+                break;
+            }
+            }
+        }
+
+        while (!ops.empty())
+        {
+            if (ops.back() == LPAREN) throw std::invalid_argument("Unmatched '('");
+            ApplyOperator(ops.back(), fragments, nfa);
+            ops.pop_back();
+        }
+        if (fragments.size() != 1) throw std::invalid_argument("Missing operand");
+        return std::move(fragments.back());
+    }
+
+    /// -----------------------------------------------------------------------
+    /// Dfa methods (mirror DFA)
+    /// -----------------------------------------------------------------------
+
+    /// @brief method to add the epsilon closure of a state to a state set
+    static constexpr void AddClosure(const NFA& nfa, size_t state, StateSet& set)
+    {
+        std::vector<size_t> stack{ state };
+        set[state / 64] |= (uint64_t{ 1 } << (state % 64));
+        while (!stack.empty())
+        {
+            size_t s = stack.back();
+            stack.pop_back();
+            for (const Transition& t : nfa.transitions[s])
+            {
+                uint64_t bit = uint64_t{ 1 } << (t.to % 64);
+                if (t.symbols == EPSILON_SET && !(set[t.to / 64] & bit))
+                {
+                    set[t.to / 64] |= bit;
+                    stack.push_back(t.to);
+                }
+            }
+        }
+    }
+
+    /// @brief method to mix a value into a hash (fnv-1a over words)
+    static constexpr uint64_t Mix(uint64_t hash, uint64_t value)
+    {
+        hash = (hash ^ value) * 1099511628211ull;
+        return hash ^ (hash >> 32);
+    }
+
+    /// @brief method to number items by equality, in order of first appearance, so
+    ///        equal items share a number and item 0 is numbered 0
+    /// @param count the number of items
+    /// @param HashOf callable hashing an item, equal items must hash equal
+    /// @param Equal callable comparing two items
+    /// @param[out] numberOf the number of every item
+    /// @return the number of distinct items
+    template <typename Hash_t, typename Equal_t>
+    static constexpr size_t Renumber(size_t count, Hash_t&& HashOf, Equal_t&& Equal,
+        std::vector<uint32_t>& numberOf)
+    {
+        std::vector<uint32_t> slots(std::bit_ceil(2 * count + 1), DFA::NO_TAG);
+        const size_t mask = slots.size() - 1;
+        numberOf.assign(count, 0);
+
+        size_t next = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t slot = HashOf(i) & mask;
+            while (slots[slot] != DFA::NO_TAG && !Equal(slots[slot], i))
+            {
+                slot = (slot + 1) & mask;
+            }
+            if (slots[slot] == DFA::NO_TAG)
+            {
+                slots[slot] = static_cast<uint32_t>(i);
+                numberOf[i] = static_cast<uint32_t>(next++);
+            }
+            else
+            {
+                numberOf[i] = numberOf[slots[slot]];
+            }
+        }
+        return next;
+    }
+
+    /// @brief method to run the powerset construction, over the symbol classes
+    ///        induced by the byte sets of the nfa. The start state is 0, and the
+    ///        dead state (the empty set) is 1. Constant evaluation is slow, so the
+    ///        closures are computed once, the moves of a state on every class are
+    ///        computed in one pass, and the state sets are kept in flat storage
+    ///        found through an open addressed hash table
+    static constexpr Tables Powerset(const NFA& nfa)
+    {
+        const size_t n = nfa.tags.size();
+        const size_t words = (n + 63) / 64;
+
+        /// refine the bytes into classes, where bytes of a class are in exactly
+        /// the same byte sets. Only the members of each set are visited, moving
+        /// them to a new class split off of their old class
+        ///
+        Tables ret;
+        std::array<size_t, 256> classOf{ };
+        std::vector<size_t> splitOf{ EPSILON_SET };
+        std::vector<size_t> splitBy{ EPSILON_SET };
+        for (size_t i = 0; i < nfa.sets.size(); ++i)
+        {
+            for (size_t w = 0; w < 4; ++w)
+            {
+                for (uint64_t bits = nfa.sets[i].bits[w]; bits != 0; bits &= bits - 1)
+                {
+                    size_t& cls = classOf[w * 64 + std::countr_zero(bits)];
+                    if (splitBy[cls] != i)
+                    {
+                        splitBy[cls] = i;
+                        splitOf[cls] = splitOf.size();
+                        splitOf.push_back(EPSILON_SET);
+                        splitBy.push_back(EPSILON_SET);
+                    }
+                    cls = splitOf[cls];
+                }
+            }
+        }
+
+        /// number the (non-empty) classes by their first byte
+        ///
+        std::vector<size_t> numberOf(splitOf.size(), EPSILON_SET);
+        size_t numClasses = 0;
+        for (size_t& cls : classOf)
+        {
+            if (numberOf[cls] == EPSILON_SET) numberOf[cls] = numClasses++;
+            cls = numberOf[cls];
+        }
+
+        /// the classes in every byte set, and the closure of every state
+        ///
+        std::vector<std::vector<size_t>> classesOf(nfa.sets.size());
+        std::vector<size_t> seenBy(numClasses, EPSILON_SET);
+        for (size_t i = 0; i < nfa.sets.size(); ++i)
+        {
+            for (size_t w = 0; w < 4; ++w)
+            {
+                for (uint64_t bits = nfa.sets[i].bits[w]; bits != 0; bits &= bits - 1)
+                {
+                    size_t cls = classOf[w * 64 + std::countr_zero(bits)];
+                    if (seenBy[cls] != i)
+                    {
+                        seenBy[cls] = i;
+                        classesOf[i].push_back(cls);
+                    }
+                }
+            }
+        }
+        std::vector<uint64_t> closures(n * words, 0);
+        for (size_t s = 0; s < n; ++s)
+        {
+            StateSet closure(words, 0);
+            AddClosure(nfa, s, closure);
+            std::copy(closure.begin(), closure.end(), closures.begin() + s * words);
+        }
+
+        std::vector<uint64_t> sets; // flat, words per state set
+        std::vector<uint32_t> slots(64, DFA::NO_TAG);
+        auto Equal = [&sets, words](size_t index, const uint64_t* set)
+        {
+            const uint64_t* other = sets.data() + index * words;
+            for (size_t w = 0; w < words; ++w)
+            {
+                if (other[w] != set[w]) return false;
+            }
+            return true;
+        };
+        auto Slot = [&slots, &Equal, words](const uint64_t* set) -> uint32_t&
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t w = 0; w < words; ++w) hash = Mix(hash, set[w]);
+
+            size_t slot = hash & (slots.size() - 1);
+            while (slots[slot] != DFA::NO_TAG && !Equal(slots[slot], set))
+            {
+                slot = (slot + 1) & (slots.size() - 1);
+            }
+            return slots[slot];
+        };
+        auto AddState = [&](const uint64_t* set) -> uint32_t
+        {
+            uint32_t& slot = Slot(set);
+            if (slot != DFA::NO_TAG) return slot;
+
+            const uint32_t index = static_cast<uint32_t>(ret.tags.size());
+            slot = index;
+            uint32_t tag = DFA::NO_TAG;
+            for (size_t w = 0; w < words; ++w)
+            {
+                for (uint64_t bits = set[w]; bits != 0; bits &= bits - 1)
+                {
+                    tag = std::min(tag, nfa.tags[w * 64 + std::countr_zero(bits)]);
+                }
+            }
+            sets.insert(sets.end(), set, set + words);
+            ret.tags.push_back(tag);
+            ret.table.resize(ret.table.size() + numClasses);
+
+            /// keep the table at most half full
+            ///
+            if (2 * ret.tags.size() > slots.size())
+            {
+                slots.assign(2 * slots.size(), DFA::NO_TAG);
+                for (size_t i = 0; i < ret.tags.size(); ++i)
+                {
+                    Slot(sets.data() + i * words) = static_cast<uint32_t>(i);
+                }
+            }
+            return index;
+        };
+
+        const StateSet empty(words, 0);
+        ret.start = AddState(closures.data() + nfa.start * words);
+        ret.dead = AddState(empty.data());
+
+        /// compute the moves of each state on every class in one pass. Classes
+        /// no transition reads lead to the dead state, and are not looked up
+        ///
+        std::vector<uint64_t> results(numClasses * words, 0);
+        std::vector<size_t> touched;
+        std::vector<size_t> touchedBy(numClasses, EPSILON_SET);
+        for (size_t state = 0; state < ret.tags.size(); ++state)
+        {
+            touched.clear();
+            for (size_t w = 0; w < words; ++w)
+            {
+                for (uint64_t bits = sets[state * words + w]; bits != 0; bits &= bits - 1)
+                {
+                    for (const Transition& t : nfa.transitions[w * 64 + std::countr_zero(bits)])
+                    {
+                        if (t.symbols == EPSILON_SET) continue;
+                        const uint64_t* closure = closures.data() + t.to * words;
+                        for (size_t cls : classesOf[t.symbols])
+                        {
+                            if (touchedBy[cls] != state)
+                            {
+                                touchedBy[cls] = state;
+                                touched.push_back(cls);
+                            }
+                            uint64_t* result = results.data() + cls * words;
+                            for (size_t i = 0; i < words; ++i) result[i] |= closure[i];
+                        }
+                    }
+                }
+            }
+
+            for (size_t cls = 0; cls < numClasses; ++cls)
+            {
+                ret.table[state * numClasses + cls] = ret.dead;
+            }
+            for (size_t cls : touched)
+            {
+                uint64_t* result = results.data() + cls * words;
+                uint32_t to = AddState(result);
+                ret.table[state * numClasses + cls] = to;
+                std::fill(result, result + words, 0);
+            }
+        }
+
+        ret.numStates = ret.tags.size();
+        ret.numClasses = numClasses;
+        for (size_t byte = 0; byte < 256; ++byte)
+        {
+            ret.classes[byte] = static_cast<uint8_t>(classOf[byte]);
+        }
+        return ret;
+    }
+
+    /// @brief method to minimize a dfa by moore's partition refinement, then merge
+    ///        the symbol classes with identical columns. Blocks are numbered by
+    ///        their first state, so the start state stays 0
+    static constexpr Tables Minimize(const Tables& dfa)
+    {
+        const size_t n = dfa.numStates;
+        const size_t k = dfa.numClasses;
+        const uint32_t* table = dfa.table.data();
+
+        /// the initial partition groups the states by case tag, then the blocks
+        /// are split by the blocks of their successors until stable
+        ///
+        std::vector<uint32_t> blockOf;
+        size_t numBlocks = Renumber(n,
+            [&dfa](size_t s) -> uint64_t { return Mix(0, dfa.tags[s]); },
+            [&dfa](size_t a, size_t b) { return dfa.tags[a] == dfa.tags[b]; },
+            blockOf);
+        while (true)
+        {
+            const uint32_t* block = blockOf.data();
+            std::vector<uint32_t> next;
+            size_t count = Renumber(n,
+                [=](size_t s) -> uint64_t
+                {
+                    uint64_t hash = Mix(0, block[s]);
+                    for (size_t c = 0; c < k; ++c) hash = Mix(hash, block[table[s * k + c]]);
+                    return hash;
+                },
+                [=](size_t a, size_t b)
+                {
+                    if (block[a] != block[b]) return false;
+                    for (size_t c = 0; c < k; ++c)
+                    {
+                        if (block[table[a * k + c]] != block[table[b * k + c]]) return false;
+                    }
+                    return true;
+                },
+                next);
+            blockOf = std::move(next);
+            if (count == numBlocks) break;
+            numBlocks = count;
+        }
+
+        /// the minimized table, still over the unmerged classes
+        ///
+        std::vector<uint32_t> blocks(numBlocks * k);
+        std::vector<uint32_t> tags(numBlocks);
+        for (size_t s = 0; s < n; ++s)
+        {
+            tags[blockOf[s]] = dfa.tags[s];
+            for (size_t c = 0; c < k; ++c)
+            {
+                blocks[blockOf[s] * k + c] = blockOf[table[s * k + c]];
+            }
+        }
+
+        /// merge the classes with identical columns
+        ///
+        const uint32_t* column = blocks.data();
+        std::vector<uint32_t> mergedOf;
+        size_t numMerged = Renumber(k,
+            [=](size_t c) -> uint64_t
+            {
+                uint64_t hash = 0;
+                for (size_t b = 0; b < numBlocks; ++b) hash = Mix(hash, column[b * k + c]);
+                return hash;
+            },
+            [=](size_t c, size_t d)
+            {
+                for (size_t b = 0; b < numBlocks; ++b)
+                {
+                    if (column[b * k + c] != column[b * k + d]) return false;
+                }
+                return true;
+            },
+            mergedOf);
+
+        Tables ret;
+        ret.numStates = numBlocks;
+        ret.numClasses = numMerged;
+        ret.start = blockOf[dfa.start];
+        ret.dead = blockOf[dfa.dead];
+        ret.tags = std::move(tags);
+        ret.table.resize(numBlocks * numMerged);
+        for (size_t b = 0; b < numBlocks; ++b)
+        {
+            for (size_t c = 0; c < k; ++c)
+            {
+                ret.table[b * numMerged + mergedOf[c]] = blocks[b * k + c];
+            }
+        }
+        for (size_t byte = 0; byte < 256; ++byte)
+        {
+            ret.classes[byte] = static_cast<uint8_t>(mergedOf[dfa.classes[byte]]);
+        }
+        return ret;
+    }
+};
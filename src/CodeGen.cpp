@@ -0,0 +1,222 @@
+/// @file CodeGen.cpp
+/// @brief Provides the definitions for the CodeGen class
+
+#include "CodeGen.hpp"
+
+#include "DFA.hpp"
+#include "RuleCase.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+
+#include <fstream>
+#include <map>
+#include <string_view>
+
+void CodeGen::EmitHeader(std::ostream &os, const Options &options)
+{
+    os << "// Generated by LexerGenLib. Do not edit.\n"
+       << "\n"
+       << "#pragma once\n"
+       << "\n"
+       << "#include <cstddef>\n"
+       << "#include <string_view>\n"
+       << "\n"
+       << "namespace " << options.nameSpace << "\n"
+       << "{\n"
+       << "    /// @brief case tag of a token no case matched\n"
+       << "    inline constexpr std::size_t NO_CASE = static_cast<std::size_t>(-1);\n"
+       << "\n"
+       << "    /// @brief represents a token matched by the scanner\n"
+       << "    struct Token\n"
+       << "    {\n"
+       << "        std::size_t caseTag; ///< the case matched, NO_CASE if none matched\n"
+       << "        std::size_t offset; ///< offset of the first byte of the token\n"
+       << "        std::size_t length; ///< the number of bytes in the token\n"
+       << "    };\n"
+       << "\n"
+       << "    /// @brief scan the longest token starting at an offset (before the end) of\n"
+       << "    ///        the input. If no case matches, a single byte NO_CASE token is scanned\n"
+       << "    Token Scan(std::string_view input, std::size_t offset);\n"
+       << "\n"
+       << "    /// @brief scan tokens from an offset, running the action of every case\n"
+       << "    ///        matched, until an action returns or the input is exhausted\n"
+       << "    /// @param offset the offset to scan from, advanced past every token scanned\n"
+       << "    /// @return the value returned by an action, 0 if the input was exhausted\n"
+       << "    int Lex(std::string_view input, std::size_t& offset);\n"
+       << "}\n";
+}
+
+void CodeGen::EmitSource(const DFA &dfa, const std::vector<RuleCase> &ruleCases,
+    std::ostream &os, const Options &options)
+{
+    os << "// Generated by LexerGenLib. Do not edit.\n"
+       << "\n"
+       << "#include \"" << options.headerName << "\"\n"
+       << "\n";
+    if (!options.prologue.empty())
+    {
+        os << options.prologue << "\n"
+           << "\n";
+    }
+    os << "namespace " << options.nameSpace << "\n"
+       << "{\n";
+    EmitScan(dfa, os);
+    os << "\n";
+    EmitLex(ruleCases, os);
+    os << "}\n";
+}
+
+void CodeGen::Emit(const DFA &dfa, const std::vector<RuleCase> &ruleCases,
+    const char *headerPath, const char *sourcePath, const Options &options)
+{
+    std::ofstream header(headerPath);
+    ENSURES_THROW(header.is_open(), std::format("Could not open file '{}'", headerPath));
+    EmitHeader(header, options);
+
+    std::ofstream source(sourcePath);
+    ENSURES_THROW(source.is_open(), std::format("Could not open file '{}'", sourcePath));
+    EmitSource(dfa, ruleCases, source, options);
+}
+
+void CodeGen::EmitScan(const DFA &dfa, std::ostream &os)
+{
+    const DFA::Tables tables = dfa.View();
+
+    os << "Token Scan(std::string_view input, std::size_t offset)\n"
+       << "{\n"
+       << "    const unsigned char* const data = reinterpret_cast<const unsigned char*>(input.data());\n"
+       << "    const unsigned char* const begin = data + offset;\n"
+       << "    const unsigned char* const end = data + input.size();\n"
+       << "    const unsigned char* p = begin;\n"
+       << "    const unsigned char* matchEnd = begin;\n"
+       << "    std::size_t matchCase = NO_CASE;\n"
+       << "\n"
+       << "    /// the start state accepting is skipped, a token can never be empty\n"
+       << "    goto start;\n";
+
+    /// group the bytes of each state by the state they lead to, so each target
+    /// is one run of case labels. Bytes leading to the dead state use the default
+    ///
+    std::vector<std::map<size_t, std::vector<size_t>>> bytesOf(dfa.States().size());
+    std::vector<bool> isTarget(dfa.States().size(), false);
+    for (const DFA::State& state : dfa.States())
+    {
+        for (size_t byte = 0; byte < 256; ++byte)
+        {
+            size_t result = dfa.Next(state.index, static_cast<char>(byte));
+            if (result != tables.dead)
+            {
+                bytesOf[state.index][result].push_back(byte);
+                isTarget[result] = true;
+            }
+        }
+    }
+
+    for (const DFA::State& state : dfa.States())
+    {
+        if (state.index == dfa.Dead()) continue; /// jumps to the dead state end the scan
+
+        /// labels no state jumps to are left out, the generated code compiles warning free
+        ///
+        os << "\n";
+        if (isTarget[state.index])
+        {
+            os << "state" << state.index << ":\n";
+            if (state.caseTag != NO_CASE_TAG)
+            {
+                os << "    matchCase = " << state.caseTag << ";\n"
+                   << "    matchEnd = p;\n";
+            }
+        }
+        if (state.index == dfa.Start())
+        {
+            os << "start:\n";
+        }
+        else if (!isTarget[state.index])
+        {
+            continue; /// unreachable
+        }
+
+        os << "    if (p == end) goto done;\n"
+           << "    switch (*p++)\n"
+           << "    {\n";
+        for (const auto& [result, bytes] : bytesOf[state.index])
+        {
+            os << "   ";
+            for (size_t i = 0; i < bytes.size(); ++i)
+            {
+                os << (i > 0 && i % 8 == 0 ? "\n   " : "") << " case " << bytes[i] << ":";
+            }
+            os << "\n        goto state" << result << ";\n";
+        }
+        os << "    default:\n"
+           << "        goto done;\n"
+           << "    }\n";
+    }
+
+    os << "\n"
+       << "done:\n"
+       << "    if (matchEnd == begin) return Token{ NO_CASE, offset, 1 };\n"
+       << "    return Token{ matchCase, offset, static_cast<std::size_t>(matchEnd - begin) };\n"
+       << "}\n";
+}
+
+void CodeGen::EmitLex(const std::vector<RuleCase> &ruleCases, std::ostream &os)
+{
+    /// the action of a case sees the lexeme, also under the case's match alias
+    ///
+    auto EmitAction = [&os](const RuleCase& ruleCase, std::string_view indent)
+    {
+        os << indent << "{\n";
+        if (!ruleCase.matchAlias.empty())
+        {
+            os << indent << "    [[maybe_unused]] const std::string_view " << ruleCase.matchAlias
+               << " = lexeme;\n";
+        }
+        os << indent << "    " << ruleCase.actionCode << "\n"
+           << indent << "}\n";
+    };
+
+    os << "int Lex(std::string_view input, std::size_t& offset)\n"
+       << "{\n"
+       << "    while (offset < input.size())\n"
+       << "    {\n"
+       << "        const Token token = Scan(input, offset);\n"
+       << "        [[maybe_unused]] const std::string_view lexeme = input.substr(token.offset, token.length);\n"
+       << "        offset += token.length;\n"
+       << "\n"
+       << "        switch (token.caseTag)\n"
+       << "        {\n";
+    for (size_t caseTag = 0; caseTag < ruleCases.size(); ++caseTag)
+    {
+        const RuleCase& ruleCase = ruleCases[caseTag];
+        if (ruleCase.patternType != RuleCase::Pattern_t::REGEX &&
+            ruleCase.patternType != RuleCase::Pattern_t::STRING)
+        {
+            continue; /// never matched by the dfa
+        }
+
+        os << "        case " << caseTag << ":\n";
+        EmitAction(ruleCase, "        ");
+        os << "            break;\n";
+    }
+    os << "        default:\n"
+       << "            break;\n"
+       << "        }\n"
+       << "    }\n";
+
+    /// end of file cases run once the input is exhausted
+    ///
+    os << "\n"
+       << "    [[maybe_unused]] const std::string_view lexeme = input.substr(input.size());\n";
+    for (const RuleCase& ruleCase : ruleCases)
+    {
+        if (ruleCase.patternType == RuleCase::Pattern_t::END_OF_FILE)
+        {
+            EmitAction(ruleCase, "    ");
+        }
+    }
+    os << "    return 0;\n"
+       << "}\n";
+}
@@ -0,0 +1,161 @@
+/// @file CompactNFA.cpp
+/// @brief Provides the definitions for CompactNFA
+
+#include "CompactNFA.hpp"
+
+#include "DFA.hpp"
+#include "NFA.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+/// @brief an edge labelled with a range of bytes
+struct RangeEdge
+{
+    uint32_t to; ///< the target
+    uint8_t lo; ///< the lowest byte
+    uint8_t hi; ///< the highest byte
+
+    auto operator<=>(const RangeEdge&) const = default;
+};
+
+/// @brief clip the range of a transition to the alphabet, appending every run of
+///        alphabet bytes within it
+/// @param transition the (symbol) transition
+/// @param[out] edges the edges to append to
+static void ClipToAlphabet(const NFA::Transition& transition, std::vector<RangeEdge>& edges)
+{
+    const size_t lo = static_cast<uint8_t>(transition.lo);
+    const size_t hi = static_cast<uint8_t>(transition.hi);
+    for (size_t byte = lo; byte <= hi; ++byte)
+    {
+        if (!ALPHABET_CLASS.Contains(static_cast<uint8_t>(byte))) continue;
+
+        const size_t runLo = byte;
+        while (byte < hi && ALPHABET_CLASS.Contains(static_cast<uint8_t>(byte + 1))) ++byte;
+        edges.push_back(RangeEdge{ 
+            .to = static_cast<uint32_t>(transition.to), 
+            .lo = static_cast<uint8_t>(runLo), 
+            .hi = static_cast<uint8_t>(byte) 
+        });
+    }
+}
+
+CompactNFA::CompactNFA(const NFA &nfa)
+    : start(static_cast<uint32_t>(nfa.start)), numCases(nfa.numCases), symbolBegin(), symbolLo(),
+      symbolHi(), symbolTargets(), epsilonBegin(), epsilonTargets(), tags()
+{
+    const size_t N = nfa.states.size();
+    ENSURES_THROW(N < std::numeric_limits<uint32_t>::max(),
+        "NFA state count exceeds the compact nfa index range");
+
+    symbolBegin.reserve(N + 1);
+    epsilonBegin.reserve(N + 1);
+    std::vector<RangeEdge> edges;
+    std::vector<RangeEdge> merged;
+    std::vector<uint32_t> epsilons;
+    for (const NFA::State& state : nfa.states)
+    {
+        edges.clear();
+        merged.clear();
+        epsilons.clear();
+        for (const NFA::Transition& transition : state.transitions)
+        {
+            if (transition.IsEpsilon())
+            {
+                epsilons.push_back(static_cast<uint32_t>(transition.to));
+            }
+            else
+            {
+                ClipToAlphabet(transition, edges);
+            }
+        }
+
+        /// sorted by target, ranges leading to the same state can be merged when
+        /// they overlap or touch
+        ///
+        std::ranges::sort(edges);
+        for (const RangeEdge& edge : edges)
+        {
+            if (!merged.empty() && merged.back().to == edge.to && edge.lo <= merged.back().hi + 1)
+            {
+                merged.back().hi = std::max(merged.back().hi, edge.hi);
+            }
+            else
+            {
+                merged.push_back(edge);
+            }
+        }
+
+        /// sorted by range, so a move on one byte stops at the first range above it
+        ///
+        std::ranges::sort(merged, { }, [](const RangeEdge& edge)
+        {
+            return std::make_tuple(edge.lo, edge.hi, edge.to);
+        });
+        std::ranges::sort(epsilons);
+        epsilons.erase(std::ranges::unique(epsilons).begin(), epsilons.end());
+
+        symbolBegin.push_back(static_cast<uint32_t>(symbolTargets.size()));
+        for (const RangeEdge& edge : merged)
+        {
+            symbolLo.push_back(edge.lo);
+            symbolHi.push_back(edge.hi);
+            symbolTargets.push_back(edge.to);
+        }
+        epsilonBegin.push_back(static_cast<uint32_t>(epsilonTargets.size()));
+        epsilonTargets.insert(epsilonTargets.end(), epsilons.begin(), epsilons.end());
+    }
+    symbolBegin.push_back(static_cast<uint32_t>(symbolTargets.size()));
+    epsilonBegin.push_back(static_cast<uint32_t>(epsilonTargets.size()));
+
+    tags.assign(N, DFA::NO_TAG);
+    for (size_t astate : nfa.accept)
+    {
+        const size_t caseTag = nfa.states[astate].caseTag;
+        tags[astate] = (caseTag == NO_CASE_TAG ? DFA::NO_TAG : static_cast<uint32_t>(caseTag));
+    }
+
+    TRACE(INFO, "Compact NFA of " << N << " states, " << symbolTargets.size() << " symbol edges, "
+        << epsilonTargets.size() << " epsilon edges" << std::endl);
+}
+
+auto CompactNFA::EpsilonClosures() const -> Closures
+{
+    const size_t N = NumStates();
+    Closures ret{ .begin = {}, .states = {} };
+    ret.begin.reserve(N + 1);
+
+    /// a state is marked with the closure it was last added to
+    ///
+    std::vector<uint32_t> markedBy(N, std::numeric_limits<uint32_t>::max());
+    std::vector<uint32_t> stack;
+    for (uint32_t stateI = 0; stateI < N; ++stateI)
+    {
+        ret.begin.push_back(static_cast<uint32_t>(ret.states.size()));
+        markedBy[stateI] = stateI;
+        stack.push_back(stateI);
+        while (!stack.empty())
+        {
+            const uint32_t state = stack.back();
+            stack.pop_back();
+            ret.states.push_back(state);
+            for (uint32_t e = epsilonBegin[state]; e < epsilonBegin[state + 1]; ++e)
+            {
+                const uint32_t result = epsilonTargets[e];
+                if (markedBy[result] != stateI)
+                {
+                    markedBy[result] = stateI;
+                    stack.push_back(result);
+                }
+            }
+        }
+    }
+    ret.begin.push_back(static_cast<uint32_t>(ret.states.size()));
+    return ret;
+}
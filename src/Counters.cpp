@@ -0,0 +1,88 @@
+/// @file Counters.cpp
+/// @brief Provides the definitions for the Counters class
+
+#include "Counters.hpp"
+
+#include "LexerUtil/Macros.hpp"
+
+#include <atomic>
+
+/// @brief the counters, indexed by Counter_t
+static std::array<std::atomic<size_t>, Counters::NUM_COUNTERS> counters{ };
+
+/// @brief memory resource behind Counters::Resource
+class CountingResource : public std::pmr::memory_resource
+{
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        Counters::Add(Counters::Counter_t::BYTES_ALLOCATED, bytes);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+Counters::Batch::~Batch()
+{
+    for (size_t counterI = 0; counterI < NUM_COUNTERS; ++counterI)
+    {
+        if (counts_.values[counterI] != 0)
+        {
+            Add(static_cast<Counter_t>(counterI), counts_.values[counterI]);
+        }
+    }
+}
+
+void Counters::Add(Counter_t counter, size_t amount)
+{
+    counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+auto Counters::Snapshot() -> Values
+{
+    Values ret;
+    for (size_t counterI = 0; counterI < NUM_COUNTERS; ++counterI)
+    {
+        ret.values[counterI] = counters[counterI].load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+void Counters::Reset()
+{
+    for (std::atomic<size_t>& counter : counters)
+    {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string_view Counters::NameOf(Counter_t counter)
+{
+    using enum Counter_t;
+    switch ( counter )
+    {
+    case NFA_STATES: return "nfa_states";
+    case DFA_STATES: return "dfa_states";
+    case CLOSURES: return "closures";
+    case WORKLIST_PUSHES: return "worklist_pushes";
+    case SPLITS: return "splits";
+    case BYTES_ALLOCATED: return "bytes_allocated";
+    default: THROW_ERR("Unhandled case in Counters::NameOf()");
+    }
+    UNREACHABLE();
+}
+
+std::pmr::memory_resource* Counters::Resource()
+{
+    static CountingResource resource;
+    return &resource;
+}
@@ -2,6 +2,8 @@
 /// @brief provide declarations for DFA
 
 #include "DFA.hpp"
+#include "CompactNFA.hpp"
+#include "Counters.hpp"
 #include "NFA.hpp"
 
 #include "LexerUtil/Constants.hpp"
@@ -9,14 +11,30 @@
 #include "LexerUtil/Macros.hpp"
 
 #include <iostream>
+#include <limits>
 #include <string>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <ranges>
+#include <thread>
+#include <tuple>
 #include <stack>
-#include <queue>
 
 using StateSet = boost::dynamic_bitset<>;
 using StateSetHash = boost::hash<boost::dynamic_bitset<>>;
+using Counter_t = Counters::Counter_t;
+
+/// @brief get the bytes held by a state set
+static size_t BytesOf(const StateSet& set)
+{
+    return set.num_blocks() * sizeof(StateSet::block_type);
+}
 
 template <typename F>
 inline void StateSetIter(const StateSet& set, F&& function)
@@ -28,22 +46,42 @@ inline void StateSetIter(const StateSet& set, F&& function)
     }
 }
 
-#warning Debug in DFA.cpp
+/// @brief write a state set to the trace output (see TRACE_DO)
 static void Debug(const StateSet& state)
 {
     std::string dbgStr = "";
     boost::to_string(state, dbgStr);
-    DBG << dbgStr << std::endl;
+    std::cout << dbgStr << std::endl;
 }
 
 DFA::DFA(const NFA &nfa)
     : DFA()
 {
-    DFA::Powerset(nfa, *this);
+    DFA::Powerset(CompactNFA(nfa), *this);
+}
+
+DFA::DFA(const NFA &nfa, size_t numThreads)
+    : DFA()
+{
+    if (numThreads == 0)
+    {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    const CompactNFA compact(nfa);
+    if (numThreads == 1)
+    {
+        DFA::Powerset(compact, *this);
+    }
+    else
+    {
+        DFA::ParallelPowerset(compact, *this, numThreads);
+    }
 }
 
 DFA::DFA()
-    : start_(INVALID_STATE_INDEX), deadState_(INVALID_STATE_INDEX), states_({})
+    : start_(INVALID_STATE_INDEX), deadState_(INVALID_STATE_INDEX), numClasses_(0), 
+      classMap_{}, states_({}), table_({}), tags_({}), accels_({})
 { }
 
 size_t DFA::Start() const
@@ -61,186 +99,478 @@ const std::vector<DFA::State> &DFA::States() const
     return states_;
 }
 
-void DFA::Minimize(DFA &dfa)
+size_t DFA::NumClasses() const
 {
-    const size_t N = dfa.states_.size();
+    return numClasses_;
+}
 
-    DBG << "Minimizing dfa with " << N << " states." << std::endl;
+auto DFA::Classes() const -> const ClassMap&
+{
+    return classMap_;
+}
+
+const std::vector<uint32_t> &DFA::Table() const
+{
+    return table_;
+}
 
-    /// compute initial partition which contains only the non-accepting 
-    /// (therefore non-tagged) set of states in the dfa and not the dead state
-    /// as tagged accept states are singular and non-merable, as well as the dead state
+auto DFA::View() const -> Tables
+{
+    return Tables{
+        .table = table_.data(),
+        .classes = classMap_.data(),
+        .tags = tags_.data(),
+        .accels = accels_.data(),
+        .numClasses = numClasses_,
+        .start = static_cast<uint32_t>(start_),
+        .dead = static_cast<uint32_t>(deadState_)
+    };
+}
+
+void DFA::InitClasses(const CompactNFA& nfa)
+{
+    numClasses_ = ClassesOf(nfa, classMap_);
+    TRACE(INFO, "Alphabet partitioned into " << numClasses_ << " symbol classes" << std::endl);
+}
+
+size_t DFA::ClassesOf(const CompactNFA &nfa, ClassMap &classMap)
+{
+    /// the bounds of the edge ranges cut the bytes into segments, and the bytes
+    /// of a segment label exactly the same edges. The compact nfa only holds
+    /// ranges within the alphabet
     ///
-    std::vector<StateSet> partition(1, StateSet(N));
-    std::vector<size_t> stateToBlock(N, INVALID_STATE_INDEX);
-    for (const State& state : dfa.states_)
+    std::array<bool, 257> cut{ };
+    cut[0] = true;
+    for (size_t edgeI = 0; edgeI < nfa.symbolTargets.size(); ++edgeI)
     {
-        if (state.caseTag == NO_CASE_TAG && state.index != dfa.deadState_)
-        {
-            partition[0].set(state.index);
-            stateToBlock[state.index] = 0;
-        }
+        cut[nfa.symbolLo[edgeI]] = true;
+        cut[nfa.symbolHi[edgeI] + 1] = true;
     }
-    
-    DBG << "Partition computed: ";
-    Debug(partition[0]);
-
-    /// initialize pre map such that the map contains the inverse function delta. 
-    /// I.e. pre[c][dest] = set of states which upon c go to dest
-    /// 
-    std::unordered_map<char, std::unordered_map<size_t, StateSet>> preMap;
-    for (char c : ALPHABET)
+    std::array<uint16_t, 256> segmentOf{ };
+    size_t numSegments = 0;
+    for (size_t byte = 0; byte < segmentOf.size(); ++byte)
     {
-        preMap[c]; // initialize every character
+        if (cut[byte]) ++numSegments;
+        segmentOf[byte] = static_cast<uint16_t>(numSegments - 1);
     }
-    for (const State& state : dfa.states_)
+
+    /// two segments are equivalent if exactly the same nfa transitions are labelled
+    /// with them, so collect the (from, to) pairs labelled with each segment
+    ///
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> signatures(numSegments);
+    for (uint32_t stateI = 0; stateI < nfa.NumStates(); ++stateI)
     {
-        for (const auto& [symbol, result] : state.transitions)
+        for (uint32_t edgeI = nfa.symbolBegin[stateI]; edgeI < nfa.symbolBegin[stateI + 1]; ++edgeI)
         {
-            if (!preMap[symbol].contains(result))
+            const size_t last = segmentOf[nfa.symbolHi[edgeI]];
+            for (size_t segment = segmentOf[nfa.symbolLo[edgeI]]; segment <= last; ++segment)
             {
-                preMap[symbol][result].resize(N);
+                signatures[segment].emplace_back(stateI, nfa.symbolTargets[edgeI]);
             }
-            preMap[symbol][result].set(state.index);
         }
     }
 
-    DBG << "PreMap calculated" << std::endl;
-
-    /// initialize work list
+    /// class 0 is reserved for symbols without any transitions (this includes 
+    /// every byte outside of the alphabet). iterate over the segments in order so
+    /// the class numbering is deterministic
     ///
-    std::queue<std::pair<StateSet, char>> worklist;
-    for (char symbol : ALPHABET)
+    std::map<std::vector<std::pair<uint32_t, uint32_t>>, uint8_t> classOfSignature;
+    classOfSignature[{}] = 0;
+    std::vector<uint8_t> classOfSegment(numSegments);
+    for (size_t segment = 0; segment < numSegments; ++segment)
     {
-        worklist.push({partition[0], symbol});
+        std::ranges::sort(signatures[segment]);
+        auto [it, inserted] = classOfSignature.try_emplace(std::move(signatures[segment]), 
+            static_cast<uint8_t>(classOfSignature.size()));
+        classOfSegment[segment] = it->second;
     }
+    for (size_t byte = 0; byte < classMap.size(); ++byte)
+    {
+        classMap[byte] = classOfSegment[segmentOf[byte]];
+    }
+    return classOfSignature.size();
+}
 
-    DBG << "Work list initialized" << std::endl;
- 
-    /// refine the partition
+void DFA::MergeClasses()
+{
+    /// symbol classes whose columns are identical in every row cannot be told 
+    /// apart by the dfa, so give each distinct column a single class. Columns are
+    /// visited in order, so class 0 stays class 0
     ///
-    StateSet preSet(N); // set of states that go into a on c
-    while(!worklist.empty())
+    const size_t numStates = states_.size();
+    std::map<std::vector<uint32_t>, uint8_t> classOfColumn;
+    std::vector<uint8_t> newClassOf(numClasses_);
+    std::vector<uint32_t> column(numStates);
+    for (size_t symbolClass = 0; symbolClass < numClasses_; ++symbolClass)
     {
-        auto [A, c] = pop(worklist);
-        preSet.reset();
+        for (size_t stateI = 0; stateI < numStates; ++stateI)
+        {
+            column[stateI] = table_[stateI * numClasses_ + symbolClass];
+        }
+        auto [it, inserted] = classOfColumn.try_emplace(column, 
+            static_cast<uint8_t>(classOfColumn.size()));
+        newClassOf[symbolClass] = it->second;
+    }
 
-        DBG << "Processing ";
-        Debug(A);
-        DBG << "   on symbol " << Escaped(c) << std::endl;
+    const size_t newNumClasses = classOfColumn.size();
+    if (newNumClasses == numClasses_) return; /// nothing to merge
 
-        if (!A.any()) continue; /// no states to act on (maybe remove?)
+    std::vector<uint32_t> newTable(numStates * newNumClasses);
+    for (size_t stateI = 0; stateI < numStates; ++stateI)
+    {
+        for (size_t symbolClass = 0; symbolClass < numClasses_; ++symbolClass)
+        {
+            newTable[stateI * newNumClasses + newClassOf[symbolClass]] = 
+                table_[stateI * numClasses_ + symbolClass];
+        }
+    }
+    for (uint8_t& symbolClass : classMap_)
+    {
+        symbolClass = newClassOf[symbolClass];
+    }
 
-        /// compute all the states that have a transition into A from c
-        ///
-        for (size_t stateI = A.find_first(); stateI != StateSet::npos; stateI = A.find_next(stateI))
+    TRACE(INFO, "Merged " << numClasses_ << " symbol classes into " << newNumClasses << std::endl);
+    numClasses_ = newNumClasses;
+    table_ = std::move(newTable);
+}
+
+void DFA::InitAccels()
+{
+    /// a state is accelerated when the bytes looping back to it form a few
+    /// ranges. The dead state loops on everything, but is never scanned in
+    ///
+    accels_.assign(states_.size(), Accel{ });
+    size_t numAccelerated = 0;
+    for (size_t stateI = 0; stateI < states_.size(); ++stateI)
+    {
+        if (stateI == deadState_) continue;
+
+        Accel accel{ };
+        bool fits = true;
+        for (size_t byte = 0; byte < classMap_.size() && fits; ++byte)
         {
-            if (preMap[c].contains(stateI))
+            if (table_[stateI * numClasses_ + classMap_[byte]] != stateI) continue;
+
+            if (accel.numRanges > 0 && accel.hi[accel.numRanges - 1] + 1u == byte)
             {
-                DBG << "stateI " << stateI << " : ";
-                DBG << "sameSize? " << preSet.size() << ' ' << preMap[c][stateI].size() << std::endl;
-                preSet |= preMap[c][stateI]; 
+                accel.hi[accel.numRanges - 1] = static_cast<uint8_t>(byte);
             }
+            else if (accel.numRanges < MAX_ACCEL_RANGES)
+            {
+                accel.lo[accel.numRanges] = static_cast<uint8_t>(byte);
+                accel.hi[accel.numRanges] = static_cast<uint8_t>(byte);
+                ++accel.numRanges;
+            }
+            else
+            {
+                fits = false;
+            }
+        }
+
+        if (fits && accel.numRanges > 0)
+        {
+            accels_[stateI] = accel;
+            ++numAccelerated;
+        }
+    }
+
+    TRACE(INFO, "Accelerated " << numAccelerated << " self-looping states" << std::endl);
+}
+
+size_t DFA::NewState(size_t caseTag)
+{
+    size_t stateIndex = states_.size();
+    ENSURES_THROW(stateIndex < std::numeric_limits<uint32_t>::max(), 
+        "DFA state count exceeds the transition table index range");
+
+    ENSURES_THROW(caseTag == NO_CASE_TAG || caseTag < NO_TAG, 
+        "DFA case tag exceeds the tag table range");
+
+    states_.emplace_back(stateIndex, caseTag);
+    tags_.push_back(caseTag == NO_CASE_TAG ? NO_TAG : static_cast<uint32_t>(caseTag));
+    table_.resize(table_.size() + numClasses_, static_cast<uint32_t>(INVALID_STATE_INDEX));
+    return stateIndex;
+}
+
+/// @brief refinable partition of a set of states (Valmari & Lehtinen). The states of
+///        a block are contiguous in elems, and a block's marked states are kept at
+///        its front, so a block is split in time proportional to its marked states
+struct RefinablePartition
+{
+    std::vector<uint32_t> elems; ///< the states, grouped by block
+    std::vector<uint32_t> loc; ///< per state, its position in elems
+    std::vector<uint32_t> blockOf; ///< per state, the block it belongs to
+    std::vector<uint32_t> first; ///< per block, the position of its first state
+    std::vector<uint32_t> mid; ///< per block, one past its last marked state
+    std::vector<uint32_t> end; ///< per block, one past its last state
+    std::vector<uint32_t> touched; ///< the blocks having marked states
+
+    /// @brief create a partition where states with the same key share a block. 
+    ///        Blocks are numbered by the first state of each key
+    /// @param keys the key of every state
+    RefinablePartition(const std::vector<size_t>& keys)
+        : elems(keys.size()), loc(keys.size()), blockOf(keys.size())
+    {
+        std::unordered_map<size_t, uint32_t> blockOfKey;
+        std::vector<uint32_t> blockSize;
+        for (size_t stateI = 0; stateI < keys.size(); ++stateI)
+        {
+            auto [it, inserted] = blockOfKey.try_emplace(keys[stateI], blockSize.size());
+            if (inserted) blockSize.push_back(0);
+            blockOf[stateI] = it->second;
+            ++blockSize[it->second];
+        }
+
+        uint32_t position = 0;
+        for (uint32_t size : blockSize)
+        {
+            first.push_back(position);
+            mid.push_back(position);
+            position += size;
+            end.push_back(position);
+        }
+        for (size_t stateI = 0; stateI < keys.size(); ++stateI)
+        {
+            uint32_t block = blockOf[stateI];
+            elems[mid[block]] = stateI;
+            loc[stateI] = mid[block]++;
         }
+        mid = first;
+    }
 
-        DBG << "Pre Set: ";
-        Debug(preSet);
+    size_t NumBlocks() const { return first.size(); }
+    size_t SizeOf(uint32_t block) const { return end[block] - first[block]; }
 
-        for (size_t partitionI = 0; partitionI < partition.size(); ++partitionI)
+    /// @brief mark a state, moving it to the marked front of its block
+    void Mark(uint32_t state)
+    {
+        uint32_t block = blockOf[state];
+        uint32_t i = loc[state];
+        uint32_t j = mid[block];
+        if (i < j) return; /// already marked
+
+        if (j == first[block])
         {
-            StateSet X = partition[partitionI] & preSet;
-            StateSet Y = partition[partitionI] & (~preSet);
+            touched.push_back(block);
+        }
+        std::swap(elems[i], elems[j]);
+        loc[elems[i]] = i;
+        loc[elems[j]] = j;
+        ++mid[block];
+    }
 
-            if (X.any() && Y.any())
+    /// @brief split every partially marked block, the marked states forming a new
+    ///        block, and unmark everything
+    /// @param onSplit called with (old block, new block) for every split performed
+    template <typename F>
+    void Split(F&& onSplit)
+    {
+        for (uint32_t block : touched)
+        {
+            if (mid[block] == end[block]) /// every state marked, nothing to split
             {
-                StateSet& smaller = (X.count() <= Y.count() ? X : Y);
-                StateSet& larger = (X.count() > Y.count() ? X : Y);
-
-                partition[partitionI] = larger;
-                partition.push_back(smaller);
+                mid[block] = first[block];
+                continue;
+            }
 
-                /// update the mapping of each state involved
-                ///
-                for (size_t stateIndex = smaller.find_first(); stateIndex != StateSet::npos; 
-                    stateIndex = smaller.find_next(stateIndex))
-                {
-                    stateToBlock[stateIndex] = partition.size()-1;
-                }
-                for (size_t stateIndex = larger.find_first(); stateIndex != StateSet::npos; 
-                    stateIndex = larger.find_next(stateIndex))
-                {
-                    stateToBlock[stateIndex] = partitionI;
-                }
-                
-                /// add to the worklist
-                ///
-                for (char symbol : ALPHABET)
-                {
-                    worklist.push({smaller, symbol});
-                }
+            uint32_t newBlock = first.size();
+            first.push_back(first[block]);
+            mid.push_back(first[block]);
+            end.push_back(mid[block]);
+            first[block] = mid[block];
+            for (uint32_t i = first[newBlock]; i < end[newBlock]; ++i)
+            {
+                blockOf[elems[i]] = newBlock;
             }
+            onSplit(block, newBlock);
         }
+        touched.clear();
     }
+};
 
-    DBG << "Partition refined." << std::endl;
+void DFA::Minimize(DFA &dfa)
+{
+    const size_t N = dfa.states_.size();
+    const size_t numClasses = dfa.numClasses_;
+
+    TRACE(INFO, "Minimizing dfa with " << N << " states." << std::endl);
+
+    /// initialize the inverse transition function, i.e. the states that go to
+    /// t upon symbol class c are pre[preOffsets[c*N + t] ... preOffsets[c*N + t + 1])
+    ///
+    std::vector<uint32_t> preOffsets(numClasses * N + 1, 0);
+    std::vector<uint32_t> pre(N * numClasses);
+    for (size_t stateI = 0; stateI < N; ++stateI)
+    {
+        for (size_t symbolClass = 0; symbolClass < numClasses; ++symbolClass)
+        {
+            ++preOffsets[symbolClass * N + dfa.table_[stateI * numClasses + symbolClass] + 1];
+        }
+    }
+    for (size_t key = 1; key < preOffsets.size(); ++key)
+    {
+        preOffsets[key] += preOffsets[key - 1];
+    }
+    std::vector<uint32_t> preFill(preOffsets.begin(), preOffsets.end() - 1);
+    for (size_t stateI = 0; stateI < N; ++stateI)
+    {
+        for (size_t symbolClass = 0; symbolClass < numClasses; ++symbolClass)
+        {
+            pre[preFill[symbolClass * N + dfa.table_[stateI * numClasses + symbolClass]]++] = stateI;
+        }
+    }
+
+    TRACE(DEBUG, "PreMap calculated" << std::endl);
 
-    /// now add the ommited accept states and dead state
+    /// compute the initial partition. States are only equivalent if they accept 
+    /// the same case, so group them by case tag (the dead state joins the 
+    /// non-accepting states, and absorbs every other state that can never accept)
     ///
+    std::vector<size_t> caseTags(N);
     for (const State& state : dfa.states_)
     {
-        if (state.caseTag != NO_CASE_TAG || state.index == dfa.deadState_)
+        caseTags[state.index] = state.caseTag;
+    }
+    RefinablePartition partition(caseTags);
+
+    Counters::Batch counts;
+    counts[Counter_t::BYTES_ALLOCATED] += (preOffsets.size() + pre.size()) * sizeof(uint32_t);
+
+    TRACE(DEBUG, "Initial partition has " << partition.NumBlocks() << " blocks" << std::endl);
+
+    /// initialize the work list of splitter blocks with every block but the 
+    /// largest one, its splits are implied by the others
+    ///
+    std::vector<uint32_t> worklist;
+    std::vector<bool> inWorklist(partition.NumBlocks(), true);
+    uint32_t largest = 0;
+    for (uint32_t block = 0; block < partition.NumBlocks(); ++block)
+    {
+        if (partition.SizeOf(block) > partition.SizeOf(largest)) largest = block;
+    }
+    for (uint32_t block = 0; block < partition.NumBlocks(); ++block)
+    {
+        if (block != largest) worklist.push_back(block);
+    }
+    inWorklist[largest] = false;
+    counts[Counter_t::WORKLIST_PUSHES] += worklist.size();
+
+    TRACE(DEBUG, "Work list initialized" << std::endl);
+
+    /// refine the partition (Hopcroft). When a block is split, the new part 
+    /// becomes a splitter if the old one still is, otherwise the smaller part does
+    ///
+    auto OnSplit = [&](uint32_t block, uint32_t newBlock)
+    {
+        inWorklist.push_back(false);
+        uint32_t next = newBlock;
+        if (!inWorklist[block] && partition.SizeOf(block) < partition.SizeOf(newBlock))
+        {
+            next = block;
+        }
+        worklist.push_back(next);
+        inWorklist[next] = true;
+        ++counts[Counter_t::SPLITS];
+        ++counts[Counter_t::WORKLIST_PUSHES];
+    };
+
+    std::vector<uint32_t> splitter; /// states of the splitter being processed
+    while (!worklist.empty())
+    {
+        uint32_t splitterBlock = worklist.back();
+        worklist.pop_back();
+        inWorklist[splitterBlock] = false;
+
+        /// snapshot the splitter, as it may itself be split below
+        ///
+        splitter.assign(partition.elems.begin() + partition.first[splitterBlock], 
+            partition.elems.begin() + partition.end[splitterBlock]);
+
+        for (size_t symbolClass = 0; symbolClass < numClasses; ++symbolClass)
         {
-            StateSet singletonSet(N);
-            singletonSet.set(state.index);
-            partition.push_back(singletonSet);
-            stateToBlock[state.index] = partition.size() - 1;
+            /// mark every state that goes into the splitter upon the class, then
+            /// split the blocks that are only partially marked
+            ///
+            for (uint32_t target : splitter)
+            {
+                size_t key = symbolClass * N + target;
+                for (uint32_t preI = preOffsets[key]; preI < preOffsets[key + 1]; ++preI)
+                {
+                    partition.Mark(pre[preI]);
+                }
+            }
+            partition.Split(OnSplit);
         }
     }
 
-    DBG << "Added omitted states." << std::endl;
+    TRACE(INFO, "Partition refined into " << partition.NumBlocks() << " blocks." << std::endl);
 
-    /// finally, make the new set of dfa states
+    /// finally, make the new set of dfa states. Number the blocks in order of their
+    /// first state so the result is deterministic (and the start state stays first)
     ///
-    std::vector<DFA::State> newStates(partition.size());
-    for (size_t partitionI = 0; partitionI < partition.size(); ++partitionI)
-    {
-        size_t repI = partition[partitionI].find_first();
-        DFA::State& repState = dfa.states_[repI];
-        newStates[partitionI] = DFA::State{
-            .index = partitionI,
-            .caseTag = repState.caseTag,
-            .transitions = {} // complete this below
+    std::vector<uint32_t> newIndexOf(partition.NumBlocks(), static_cast<uint32_t>(INVALID_STATE_INDEX));
+    std::vector<uint32_t> representative;
+    for (size_t stateI = 0; stateI < N; ++stateI)
+    {
+        uint32_t block = partition.blockOf[stateI];
+        if (newIndexOf[block] == static_cast<uint32_t>(INVALID_STATE_INDEX))
+        {
+            newIndexOf[block] = representative.size();
+            representative.push_back(stateI);
+        }
+    }
+
+    std::vector<DFA::State> newStates(representative.size());
+    std::vector<uint32_t> newTable(representative.size() * numClasses);
+    std::vector<uint32_t> newTags(representative.size());
+    for (size_t newI = 0; newI < representative.size(); ++newI)
+    {
+        size_t repI = representative[newI];
+        newStates[newI] = DFA::State{
+            .index = newI,
+            .caseTag = dfa.states_[repI].caseTag
         };
-        for (const auto& [symbol, oldResult] : repState.transitions)
+        newTags[newI] = dfa.tags_[repI];
+        for (size_t symbolClass = 0; symbolClass < numClasses; ++symbolClass)
         {
-            newStates[partitionI].transitions[symbol] = stateToBlock[oldResult];
+            size_t oldResult = dfa.table_[repI * numClasses + symbolClass];
+            newTable[newI * numClasses + symbolClass] = newIndexOf[partition.blockOf[oldResult]];
         }
     }
     dfa.states_ = std::move(newStates);
-    dfa.start_ = stateToBlock[dfa.start_];
-    dfa.deadState_ = stateToBlock[dfa.deadState_];
+    dfa.table_ = std::move(newTable);
+    dfa.tags_ = std::move(newTags);
+    dfa.start_ = newIndexOf[partition.blockOf[dfa.start_]];
+    dfa.deadState_ = newIndexOf[partition.blockOf[dfa.deadState_]];
+    counts[Counter_t::BYTES_ALLOCATED] += dfa.table_.size() * sizeof(uint32_t);
+    dfa.MergeClasses();
+    dfa.InitAccels();
 
-    DBG << "DFA minimized." << std::endl;
+    TRACE(INFO, "DFA minimized." << std::endl);
 }
 
-static std::vector<StateSet> InitEpClosureCache(const NFA &nfa)
+static std::vector<StateSet> InitEpClosureCache(const CompactNFA &nfa)
 {
-    std::vector<StateSet> closureCache(nfa.states.size());
+    /// an epsilon-free nfa (see NFAOptimizer) needs no closures, and skips the
+    /// n bit set per state
+    ///
+    if (nfa.EpsilonFree()) return {};
 
-    for (size_t index = 0; index < nfa.states.size(); ++index)
+    std::vector<StateSet> closureCache(nfa.NumStates());
+
+    for (size_t index = 0; index < nfa.NumStates(); ++index)
     {
-        StateSet closedList(nfa.states.size()); // set of states already visted
-        std::stack<size_t> fringe;              // states to visit
+        StateSet closedList(nfa.NumStates()); // set of states already visted
+        std::stack<size_t> fringe;            // states to visit
         fringe.push(index);
 
         while (!fringe.empty())
         {
             size_t index = pop(fringe);
-            const NFA::State &state = nfa.states.at(index);
-
-            for (const auto &[action, resultState] : state.transitions)
+            for (uint32_t edgeI = nfa.epsilonBegin[index]; edgeI < nfa.epsilonBegin[index + 1]; ++edgeI)
             {
-                if (action == EPSILON && !closedList[resultState])
+                const uint32_t resultState = nfa.epsilonTargets[edgeI];
+                if (!closedList[resultState])
                 {
                     closedList.set(resultState);
                     fringe.push(resultState);
@@ -254,124 +584,479 @@ static std::vector<StateSet> InitEpClosureCache(const NFA &nfa)
     return closureCache;
 }
 
-static void EpClosure(const std::vector<StateSet> &closureCache, StateSet &set)
+static void EpClosure(const std::vector<StateSet> &closureCache, StateSet &set, 
+    Counters::Batch& counts)
 {
+    if (closureCache.empty()) return;
+    ++counts[Counter_t::CLOSURES];
     for (size_t i = set.find_first(); i != StateSet::npos; i = set.find_next(i))
     {
         set |= closureCache[i];
     }
 }
 
-static void Move(const NFA &nfa, char symbol, StateSet &set)
+/// @brief index of the nfa's symbol transitions by symbol class, so a move only 
+///        visits the states that actually have a transition on the class
+struct MoveIndex
 {
-    StateSet result(set.size());
-    for (size_t i = set.find_first(); i != StateSet::npos; i = set.find_next(i))
+    /// @brief represents a transition out of a state on a symbol class
+    struct Edge
     {
-        for (const auto &[action, s0] : nfa.states[i].transitions)
+        size_t symbolClass; ///< the symbol class of the transition
+        size_t to; ///< the index of the result state
+    };
+
+    std::vector<StateSet> sources; ///< per class, the states with a transition on the class
+    std::vector<size_t> offsets; ///< per state, the first of its edges (N+1 entries)
+    std::vector<Edge> edges; ///< edges of every state, sorted by symbol class per state
+};
+
+static MoveIndex InitMoveIndex(const CompactNFA& nfa, const DFA::ClassMap& classMap, size_t numClasses)
+{
+    const size_t N = nfa.NumStates();
+    MoveIndex index{
+        .sources = std::vector<StateSet>(numClasses, StateSet(N)),
+        .offsets = {},
+        .edges = {}
+    };
+    index.offsets.reserve(N + 1);
+
+    for (size_t stateI = 0; stateI < N; ++stateI)
+    {
+        size_t first = index.edges.size();
+        index.offsets.push_back(first);
+        for (uint32_t edgeI = nfa.symbolBegin[stateI]; edgeI < nfa.symbolBegin[stateI + 1]; ++edgeI)
         {
-            if (action == symbol)
+            /// a range spans one or more classes, and a class never lies partly
+            /// outside of it
+            ///
+            size_t lastClass = 0; /// class 0 never moves
+            for (size_t byte = nfa.symbolLo[edgeI]; byte <= nfa.symbolHi[edgeI]; ++byte)
             {
-                result.set(s0);
+                const size_t symbolClass = classMap[byte];
+                if (symbolClass == lastClass) continue;
+                lastClass = symbolClass;
+
+                index.edges.emplace_back(symbolClass, nfa.symbolTargets[edgeI]);
+                index.sources[symbolClass].set(stateI);
             }
         }
+
+        /// symbols of the same class lead to the same states, so drop duplicates
+        ///
+        auto stateEdges = std::ranges::subrange(index.edges.begin() + first, index.edges.end());
+        auto byClassThenTo = [](const MoveIndex::Edge& a, const MoveIndex::Edge& b)
+        {
+            return std::tie(a.symbolClass, a.to) < std::tie(b.symbolClass, b.to);
+        };
+        auto sameEdge = [](const MoveIndex::Edge& a, const MoveIndex::Edge& b)
+        {
+            return a.symbolClass == b.symbolClass && a.to == b.to;
+        };
+        std::ranges::sort(stateEdges, byClassThenTo);
+        index.edges.erase(std::ranges::unique(stateEdges, sameEdge).begin(), index.edges.end());
     }
-    set = std::move(result);
+    index.offsets.push_back(index.edges.size());
+
+    return index;
 }
 
-static void NewState(const NFA& nfa, const StateSet& nfaAccepting, const StateSet& nfaStateSet, 
-    std::vector<DFA::State>& states, std::unordered_map<StateSet, size_t, StateSetHash>& mapping)
+/// @brief compute the set of states reached from a set upon a symbol class. Does
+///        not allocate, as long as the scratch and result sets are already sized
+/// @param index the move index of the nfa
+/// @param symbolClass the symbol class moved upon
+/// @param set the set of states to move from
+/// @param scratch scratch set, overwritten
+/// @param result the resulting set of states, overwritten
+static void Move(const MoveIndex& index, size_t symbolClass, const StateSet& set,
+    StateSet& scratch, StateSet& result)
 {
-    /// calculate set of accepting states in the set of states and use first available rule tag
+    scratch = set;
+    scratch &= index.sources[symbolClass];
+    result.reset();
+
+    StateSetIter(scratch, [&](size_t stateIndex)
+    {
+        for (size_t edgeI = index.offsets[stateIndex]; edgeI < index.offsets[stateIndex + 1]; ++edgeI)
+        {
+            const MoveIndex::Edge& edge = index.edges[edgeI];
+            if (edge.symbolClass > symbolClass) break; /// edges are sorted by class
+            if (edge.symbolClass == symbolClass)
+            {
+                result.set(edge.to);
+            }
+        }
+    });
+}
+
+static size_t CaseTagOf(const CompactNFA& nfa, const StateSet& nfaAccepting, const StateSet& nfaStateSet)
+{
+    /// calculate set of accepting states in the set of states and use the tag of 
+    /// the highest priority (lowest numbered) rule among them
     ///
     StateSet accepted = (nfaStateSet & nfaAccepting);
-    size_t dfaStateRuleTag = NO_CASE_TAG;
-    if (accepted.any())
+    uint32_t dfaStateRuleTag = DFA::NO_TAG;
+    StateSetIter(accepted, [&](size_t stateIndex)
     {
-        dfaStateRuleTag = nfa.states[accepted.find_first()].caseTag;
-    }
+        dfaStateRuleTag = std::min(dfaStateRuleTag, nfa.tags[stateIndex]);
+    });
+    return (dfaStateRuleTag == DFA::NO_TAG ? NO_CASE_TAG : dfaStateRuleTag);
+}
 
-    /// add the state and update the mapping of the state set to the state index
-    ///
-    states.emplace_back(
-        states.size(),
-        dfaStateRuleTag,
-        std::unordered_map<char, size_t>{}
-    );
-    mapping[nfaStateSet] = states.size()-1;
+/// @brief get the set of accepting states of an nfa
+static StateSet AcceptingOf(const CompactNFA& nfa)
+{
+    StateSet accepting(nfa.NumStates());
+    for (size_t stateI = 0; stateI < nfa.NumStates(); ++stateI)
+    {
+        if (nfa.tags[stateI] != DFA::NO_TAG) accepting.set(stateI);
+    }
+    return accepting;
 }
 
-void DFA::Powerset(const NFA &nfa, DFA &dfa)
+void DFA::Powerset(const CompactNFA &nfa, DFA &dfa)
 {
+    /// partition the alphabet into symbol classes and index the nfa transitions
+    /// by them. Class 0 has no transitions, so it never needs to be evaluated
+    /// and is left to go to the dead state
+    ///
+    dfa.InitClasses(nfa);
+    MoveIndex moveIndex = InitMoveIndex(nfa, dfa.classMap_, dfa.numClasses_);
+
     /// initialize cache of nfa closures and bitset for nfa accepting state
     ///
     std::vector<StateSet> closureCache = InitEpClosureCache(nfa);
-    StateSet nfaAccept(nfa.states.size());
-    for (size_t astate : nfa.accept)
-    {
-        nfaAccept.set(astate);
-    }
+    const StateSet nfaAccept = AcceptingOf(nfa);
+
+    Counters::Batch counts;
+    counts[Counter_t::CLOSURES] += closureCache.size();
+    counts[Counter_t::BYTES_ALLOCATED] += closureCache.size() * BytesOf(nfaAccept);
 
     /// setyp dfa related variables
     ///
-    std::vector<DFA::State>& states = dfa.states_;
-    states.reserve(nfa.states.size() / 2); /// heuristically guess max states of dfa
+    dfa.states_.reserve(nfa.NumStates() / 2); /// heuristically guess max states of dfa
     std::unordered_map<StateSet, size_t, StateSetHash> mapping;
     
-    /// initialize fringe and add starting and dead state to it
+    /// initialize fringe and add starting and dead state to it. The fringe holds
+    /// dfa state indices, whose nfa state sets are the (node-stable) keys of the mapping
     ///
-    std::stack<StateSet> fringe;
+    std::stack<size_t> fringe;
+    std::vector<const StateSet*> setOf;
+    auto AddState = [&](const StateSet& nfaStateSet) -> size_t
+    {
+        auto [it, inserted] = mapping.try_emplace(nfaStateSet, dfa.states_.size());
+        dfa.NewState(CaseTagOf(nfa, nfaAccept, nfaStateSet));
+        setOf.push_back(&it->first);
+        return it->second;
+    };
     
-    StateSet state(nfa.states.size()); 
+    StateSet state(nfa.NumStates()); 
     state.set(nfa.start);
-    EpClosure(closureCache, state);
-    fringe.push(state);
-    NewState(nfa, nfaAccept, state, states, mapping);
-    dfa.start_ = states.size()-1;
-
-    StateSet deadState(nfa.states.size()); /// all 0
-    NewState(nfa, nfaAccept, deadState, states, mapping);
-    dfa.deadState_ = states.size()-1;
+    EpClosure(closureCache, state, counts);
+    dfa.start_ = AddState(state);
+    fringe.push(dfa.start_);
+    ++counts[Counter_t::WORKLIST_PUSHES];
+
+    StateSet deadState(nfa.NumStates()); /// all 0
+    dfa.deadState_ = AddState(deadState);
     /// avoid pushing dead state to fringe. DFA stops when encountering dead state,
     /// so no need to calculate anything with dead state
 
-    DBG << "Starting State: ";
-    Debug(state);
+    TRACE(DEBUG, "Starting State: ");
+    TRACE_DO(DEBUG, Debug(state));
 
-    DBG << "Dead State: ";
-    Debug(deadState);
+    TRACE(DEBUG, "Dead State: ");
+    TRACE_DO(DEBUG, Debug(deadState));
 
-    /// calculate the powerset construction of nfa 
+    /// calculate the powerset construction of nfa. The scratch sets are sized 
+    /// once, so evaluating a (state, symbol class) pair does not allocate unless
+    /// it discovers a new state
     ///
+    StateSet scratch(nfa.NumStates());
+    StateSet s0(nfa.NumStates());
     while (!fringe.empty())
     {
-        state = pop(fringe);
-        StateSet s0;   
-        DBG << "Evaluating ";
-        Debug(state);
+        size_t stateIndex = pop(fringe);
+        TRACE(VERBOSE, "Evaluating ");
+        TRACE_DO(VERBOSE, Debug(*setOf[stateIndex]));
+
+        for (size_t symbolClass = 1; symbolClass < dfa.numClasses_; ++symbolClass)
+        {
+            Move(moveIndex, symbolClass, *setOf[stateIndex], scratch, s0);
+            EpClosure(closureCache, s0, counts);
+            TRACE(VERBOSE, "    (class " << symbolClass << ") resulted in ");
+            TRACE_DO(VERBOSE, Debug(s0));
+
+            size_t resultIndex;
+            if (auto found = mapping.find(s0); found != mapping.end())
+            {
+                resultIndex = found->second;
+            }
+            else
+            {
+                resultIndex = AddState(s0);
+                fringe.push(resultIndex);
+                ++counts[Counter_t::WORKLIST_PUSHES];
+            }
+            dfa.table_[stateIndex * dfa.numClasses_ + symbolClass] = resultIndex;
+        }
+    }
+
+    /// fill in the dead state transitions and the columns of class 0. Keeps the
+    /// table total, so a lookup never needs a bounds check
+    ///
+    for (uint32_t& result : dfa.table_)
+    {
+        if (result == static_cast<uint32_t>(INVALID_STATE_INDEX))
+        {
+            result = dfa.deadState_;
+        }
+    }
+    counts[Counter_t::DFA_STATES] += dfa.states_.size();
+    counts[Counter_t::BYTES_ALLOCATED] += mapping.size() * BytesOf(nfaAccept) 
+        + dfa.table_.size() * sizeof(uint32_t);
+    dfa.MergeClasses();
+    dfa.InitAccels();
+}
+
+/// @brief a dfa state waiting to be evaluated by the parallel powerset construction
+struct PowersetTask
+{
+    uint32_t id; ///< the provisional id of the state
+    const StateSet* set; ///< the nfa state set of the state (a key of the state map)
+};
+
+/// @brief nfa state set -> provisional dfa state id map, shared by the workers of the
+///        parallel powerset construction. It is sharded by hash with a lock per shard,
+///        so workers rarely contend, and its keys are node-stable, so a pointer to a
+///        key stays valid while other workers insert
+struct StateSetShards
+{
+    static constexpr size_t NUM_SHARDS = 64;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<StateSet, uint32_t, StateSetHash> map;
+    };
 
-        for (char symbol : ALPHABET)
+    /// @brief find a set, or insert it with the next provisional id
+    /// @return the state of the set, and if it was inserted by this call
+    std::pair<PowersetTask, bool> Insert(const StateSet& set)
+    {
+        const size_t hash = StateSetHash{}(set);
+        Shard& shard = shards[hash % NUM_SHARDS];
+
+        std::lock_guard lock(shard.mutex);
+        auto [it, inserted] = shard.map.try_emplace(set, 0);
+        if (inserted)
         {
-            s0 = state; 
-            Move(nfa, symbol, s0);
-            EpClosure(closureCache, s0);
-            DBG << std::format("    ({}) resulted in ", Escaped(symbol));
-            Debug(s0);
+            it->second = static_cast<uint32_t>(nextId.fetch_add(1, std::memory_order_relaxed));
+        }
+        return { PowersetTask{ .id = it->second, .set = &it->first }, inserted };
+    }
+
+    std::array<Shard, NUM_SHARDS> shards;
+    std::atomic<size_t> nextId = 0;
+};
+
+/// @brief the fringe of a worker of the parallel powerset construction. The owner
+///        works depth first from the back, idle workers steal from the front
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<PowersetTask> tasks;
+};
+
+/// @brief the states evaluated by a worker of the parallel powerset construction
+struct PowersetRows
+{
+    std::vector<uint32_t> ids; ///< provisional id of every evaluated state
+    std::vector<size_t> caseTags; ///< case tag of every evaluated state
+    std::vector<uint32_t> rows; ///< transition row (of provisional ids) of every evaluated state
+};
 
-            if (!mapping.contains(s0))
+void DFA::ParallelPowerset(const CompactNFA &nfa, DFA &dfa, size_t numThreads)
+{
+    /// the classes, move index and closures are built once and only read by
+    /// the workers
+    ///
+    dfa.InitClasses(nfa);
+    const MoveIndex moveIndex = InitMoveIndex(nfa, dfa.classMap_, dfa.numClasses_);
+    const std::vector<StateSet> closureCache = InitEpClosureCache(nfa);
+    const StateSet nfaAccept = AcceptingOf(nfa);
+    const size_t numClasses = dfa.numClasses_;
+
+    Counters::Batch counts;
+    counts[Counter_t::CLOSURES] += closureCache.size();
+    counts[Counter_t::BYTES_ALLOCATED] += closureCache.size() * BytesOf(nfaAccept);
+
+    /// the start state is the first task, the dead state is never evaluated
+    ///
+    StateSetShards mapping;
+    StateSet startSet(nfa.NumStates());
+    startSet.set(nfa.start);
+    EpClosure(closureCache, startSet, counts);
+    const PowersetTask start = mapping.Insert(startSet).first;
+    const PowersetTask dead = mapping.Insert(StateSet(nfa.NumStates())).first;
+
+    std::vector<WorkQueue> queues(numThreads);
+    std::vector<PowersetRows> outputs(numThreads);
+    queues[0].tasks.push_back(start);
+    ++counts[Counter_t::WORKLIST_PUSHES];
+    std::atomic<size_t> pending = 1; /// tasks pushed but not yet fully evaluated
+
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto Worker = [&](size_t self)
+    {
+        auto Pop = [&](PowersetTask& task) -> bool
+        {
+            for (size_t i = 0; i < numThreads; ++i)
             {
-                NewState(nfa, nfaAccept, s0, states, mapping);
-                fringe.push(s0);
+                WorkQueue& queue = queues[(self + i) % numThreads];
+                std::lock_guard lock(queue.mutex);
+                if (queue.tasks.empty()) continue;
+
+                if (i == 0)
+                {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                }
+                else
+                {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+                return true;
+            }
+            return false;
+        };
+
+        Counters::Batch workerCounts;
+        try
+        {
+            StateSet scratch(nfa.NumStates());
+            StateSet s0(nfa.NumStates());
+            PowersetRows& out = outputs[self];
+            PowersetTask task{ };
+            while (!failed.load(std::memory_order_relaxed))
+            {
+                if (!Pop(task))
+                {
+                    if (pending.load(std::memory_order_acquire) == 0) break;
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                out.ids.push_back(task.id);
+                out.caseTags.push_back(CaseTagOf(nfa, nfaAccept, *task.set));
+                const size_t row = out.rows.size();
+                out.rows.resize(row + numClasses, dead.id);
+                for (size_t symbolClass = 1; symbolClass < numClasses; ++symbolClass)
+                {
+                    Move(moveIndex, symbolClass, *task.set, scratch, s0);
+                    EpClosure(closureCache, s0, workerCounts);
+
+                    auto [result, inserted] = mapping.Insert(s0);
+                    out.rows[row + symbolClass] = result.id;
+                    if (inserted)
+                    {
+                        pending.fetch_add(1, std::memory_order_relaxed);
+                        ++workerCounts[Counter_t::WORKLIST_PUSHES];
+                        std::lock_guard lock(queues[self].mutex);
+                        queues[self].tasks.push_back(result);
+                    }
+                }
+                pending.fetch_sub(1, std::memory_order_acq_rel);
             }
-            states[mapping[state]].transitions[symbol] = mapping[s0];
-            s0.reset();
         }
+        catch (...)
+        {
+            std::lock_guard lock(errorMutex);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (size_t i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back(Worker, i);
     }
+    Worker(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    if (error) std::rethrow_exception(error);
 
-    /// fill in the dead state transitions. Not entirely neccessary, but keeps
-    /// the dfa well-formed and consistant
+    const size_t numStates = mapping.nextId.load();
+    ENSURES_THROW(numStates < std::numeric_limits<uint32_t>::max(), 
+        "DFA state count exceeds the transition table index range");
+
+    /// collect the rows by provisional id
     ///
-    for (char symbol : ALPHABET)
+    std::vector<const uint32_t*> rowOf(numStates, nullptr);
+    std::vector<size_t> caseTagOf(numStates, NO_CASE_TAG);
+    for (const PowersetRows& out : outputs)
     {
-        states[dfa.deadState_].transitions[symbol] = dfa.deadState_;
+        for (size_t i = 0; i < out.ids.size(); ++i)
+        {
+            rowOf[out.ids[i]] = out.rows.data() + i * numClasses;
+            caseTagOf[out.ids[i]] = out.caseTags[i];
+        }
+    }
+
+    /// provisional ids depend on scheduling, so renumber the states breadth
+    /// first from the start state, visiting the classes in order
+    ///
+    const uint32_t UNNUMBERED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> newId(numStates, UNNUMBERED);
+    std::vector<uint32_t> order;
+    order.reserve(numStates);
+    auto Number = [&](uint32_t id)
+    {
+        newId[id] = static_cast<uint32_t>(order.size());
+        order.push_back(id);
+    };
+    Number(start.id);
+    Number(dead.id);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (order[i] == dead.id) continue;
+        for (size_t symbolClass = 0; symbolClass < numClasses; ++symbolClass)
+        {
+            uint32_t result = rowOf[order[i]][symbolClass];
+            if (newId[result] == UNNUMBERED) Number(result);
+        }
     }
+
+    dfa.states_.reserve(numStates);
+    for (uint32_t id : order)
+    {
+        dfa.NewState(caseTagOf[id]);
+    }
+    dfa.start_ = newId[start.id];
+    dfa.deadState_ = newId[dead.id];
+    for (size_t stateI = 0; stateI < order.size(); ++stateI)
+    {
+        const uint32_t* row = rowOf[order[stateI]];
+        for (size_t symbolClass = 0; symbolClass < numClasses; ++symbolClass)
+        {
+            dfa.table_[stateI * numClasses + symbolClass] = 
+                (row == nullptr ? dfa.deadState_ : newId[row[symbolClass]]);
+        }
+    }
+
+    counts[Counter_t::DFA_STATES] += dfa.states_.size();
+    counts[Counter_t::BYTES_ALLOCATED] += numStates * BytesOf(nfaAccept) 
+        + dfa.table_.size() * sizeof(uint32_t);
+    TRACE(INFO, "Parallel powerset built " << numStates << " states on " << numThreads 
+        << " threads" << std::endl);
+    dfa.MergeClasses();
+    dfa.InitAccels();
 }
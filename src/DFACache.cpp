@@ -0,0 +1,137 @@
+/// @file DFACache.cpp
+/// @brief Provides the definitions for the DFACache class
+
+#include "DFACache.hpp"
+
+#include "DFA.hpp"
+#include "NFABuilder.hpp"
+#include "RuleCase.hpp"
+
+#include "LexerUtil/Macros.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include <unistd.h>
+
+DFACache::DFACache(std::string directory)
+    : directory_(std::move(directory)), hits_(0), misses_(0)
+{
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    ENSURES_THROW(!error, std::format("Could not create cache directory '{}': {}",
+        directory_, error.message()));
+}
+
+DFAImage DFACache::Load(const std::vector<RuleCase> &ruleCases)
+{
+    const std::string rules = Normalized(ruleCases);
+    const std::string path = PathOf(Key(rules));
+
+    /// on a hit the image is used as it is, once it is known to be built
+    /// from these rules and not from others sharing the key
+    ///
+    if (std::filesystem::exists(path))
+    {
+        try
+        {
+            DFAImage image(path.c_str());
+            if (image.Rules() == rules)
+            {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return image;
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            /// damaged or foreign image, rebuild it below
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+
+    NFA nfa = NFABuilder::Build(ruleCases);
+    DFA dfa(nfa);
+    DFA::Minimize(dfa);
+
+    /// the temporary name is unique across processes (pid) and threads, so
+    /// concurrent writers never share a file. rename() atomically replaces
+    /// any image published in between, which holds the same dfa
+    ///
+    const std::string temp = std::format("{}.{}.{}.tmp", path, ::getpid(),
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    try
+    {
+        DFAImage::Write(dfa, temp.c_str(), rules);
+    }
+    catch (...)
+    {
+        std::remove(temp.c_str());
+        throw;
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temp.c_str());
+        THROW_ERR(std::format("Could not publish dfa image '{}'", path));
+    }
+
+    return DFAImage(path.c_str());
+}
+
+auto DFACache::Statistics() const -> Stats
+{
+    return Stats{
+        .hits = hits_.load(std::memory_order_relaxed),
+        .misses = misses_.load(std::memory_order_relaxed)
+    };
+}
+
+std::string DFACache::Normalized(const std::vector<RuleCase> &ruleCases)
+{
+    std::string ret;
+    auto Append = [&ret](const void* data, size_t size)
+    {
+        ret.append(static_cast<const char*>(data), size);
+    };
+
+    /// lengths are written before data, so the boundaries between patterns
+    /// are part of the encoding. The pattern of a no-match or end of file case
+    /// is ignored by the builder, so it is left out
+    ///
+    const uint64_t version = COMPILER_VERSION;
+    const uint64_t numCases = ruleCases.size();
+    Append(&version, sizeof(version));
+    Append(&numCases, sizeof(numCases));
+    for (const RuleCase& ruleCase : ruleCases)
+    {
+        const uint64_t type = static_cast<uint64_t>(ruleCase.patternType);
+        const bool hasPattern = (ruleCase.patternType == RuleCase::Pattern_t::REGEX ||
+            ruleCase.patternType == RuleCase::Pattern_t::STRING);
+        const uint64_t length = (hasPattern ? ruleCase.patternData.size() : 0);
+        Append(&type, sizeof(type));
+        Append(&length, sizeof(length));
+        Append(ruleCase.patternData.data(), length);
+    }
+    return ret;
+}
+
+uint64_t DFACache::Key(const std::vector<RuleCase> &ruleCases)
+{
+    return Key(Normalized(ruleCases));
+}
+
+uint64_t DFACache::Key(std::string_view rules)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char byte : rules)
+    {
+        hash = (hash ^ static_cast<uint8_t>(byte)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string DFACache::PathOf(uint64_t key) const
+{
+    return std::format("{}/{:016x}.dfa", directory_, key);
+}
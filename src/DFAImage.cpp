@@ -0,0 +1,168 @@
+/// @file DFAImage.cpp
+/// @brief Provides the definitions for the DFAImage class
+
+#include "DFAImage.hpp"
+
+#include "LexerUtil/Macros.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+static_assert(sizeof(DFA::Accel) % sizeof(uint32_t) == 0, 
+    "the sections of an image after the accels must stay 4 byte aligned");
+
+void DFAImage::Write(const DFA &dfa, const char *path, std::string_view rules)
+{
+    EXPECTS_THROW(rules.size() < std::numeric_limits<uint32_t>::max(), 
+        std::format("Rules too large for dfa image '{}'", path));
+    const DFA::Tables tables = dfa.View();
+    const size_t numStates = dfa.States().size();
+    const size_t numClasses = tables.numClasses;
+
+    /// the sections after the header are contiguous, so they are assembled
+    /// once to compute the checksum and then written as they are
+    ///
+    std::vector<uint8_t> body(ImageSize(numStates, numClasses, rules.size()) - sizeof(Header));
+    uint8_t* out = body.data();
+    std::memcpy(out, tables.classes, 256);
+    out += 256;
+    std::memcpy(out, tables.tags, numStates * sizeof(uint32_t));
+    out += numStates * sizeof(uint32_t);
+    if (tables.accels != nullptr)
+    {
+        std::memcpy(out, tables.accels, numStates * sizeof(DFA::Accel));
+    }
+    out += numStates * sizeof(DFA::Accel);
+    std::memcpy(out, tables.table, numStates * numClasses * sizeof(uint32_t));
+    out += numStates * numClasses * sizeof(uint32_t);
+    std::memcpy(out, rules.data(), rules.size());
+
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(body.data());
+    const Header header{
+        .magic = MAGIC,
+        .version = VERSION,
+        .numStates = static_cast<uint32_t>(numStates),
+        .numClasses = static_cast<uint32_t>(numClasses),
+        .start = tables.start,
+        .dead = tables.dead,
+        .checksum = Checksum(words, body.size() / sizeof(uint32_t)),
+        .rulesSize = static_cast<uint32_t>(rules.size())
+    };
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    ENSURES_THROW(file.is_open(), std::format("Could not open file '{}'", path));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(body.data()), body.size());
+    file.flush();
+    ENSURES_THROW(file.good(), std::format("Could not write dfa image '{}'", path));
+}
+
+DFAImage::DFAImage(const char *path)
+    : file_(path), header_{}, classes_(nullptr), tags_(nullptr), accels_(nullptr), table_(nullptr),
+      rules_(nullptr)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(file_.View().data());
+    const size_t size = file_.Size();
+
+    ENSURES_THROW(size >= sizeof(Header), std::format("Truncated dfa image '{}'", path));
+    std::memcpy(&header_, data, sizeof(Header));
+
+    ENSURES_THROW(header_.magic == MAGIC, std::format("'{}' is not a dfa image "
+        "(or was written with another byte order)", path));
+    ENSURES_THROW(header_.version == VERSION, std::format("Dfa image '{}' has version {}, "
+        "expected {}", path, header_.version, VERSION));
+
+    /// bound the dimensions before computing the size, so it cannot overflow
+    ///
+    ENSURES_THROW(header_.numClasses >= 1 && header_.numClasses <= 256 &&
+        header_.numStates >= 1 && header_.numStates <= size / sizeof(uint32_t) &&
+        header_.rulesSize <= size && 
+        size == ImageSize(header_.numStates, header_.numClasses, header_.rulesSize),
+        std::format("Truncated or corrupt dfa image '{}'", path));
+
+    classes_ = data + sizeof(Header);
+    ENSURES_THROW(header_.checksum == Checksum(reinterpret_cast<const uint32_t*>(classes_),
+        (size - sizeof(Header)) / sizeof(uint32_t)),
+        std::format("Checksum mismatch in dfa image '{}'", path));
+
+    tags_ = reinterpret_cast<const uint32_t*>(classes_ + 256);
+    accels_ = reinterpret_cast<const DFA::Accel*>(tags_ + header_.numStates);
+    table_ = reinterpret_cast<const uint32_t*>(accels_ + header_.numStates);
+    rules_ = reinterpret_cast<const char*>(table_ + 
+        static_cast<size_t>(header_.numStates) * header_.numClasses);
+
+    /// a well formed checksum does not make a crafted image safe to scan,
+    /// so every index is checked to be in range
+    ///
+    bool inRange = (header_.start < header_.numStates && header_.dead < header_.numStates);
+    for (size_t byte = 0; byte < 256; ++byte)
+    {
+        inRange &= (classes_[byte] < header_.numClasses);
+    }
+    const size_t numEntries = static_cast<size_t>(header_.numStates) * header_.numClasses;
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        inRange &= (table_[i] < header_.numStates);
+    }
+    ENSURES_THROW(inRange, std::format("Out of range index in dfa image '{}'", path));
+
+    /// a scanner trusts the acceleration to skip bytes, so every byte it
+    /// skips must really loop back to the state
+    ///
+    bool selfLoops = true;
+    for (size_t state = 0; state < header_.numStates; ++state)
+    {
+        const DFA::Accel& accel = accels_[state];
+        selfLoops &= (accel.numRanges <= DFA::MAX_ACCEL_RANGES);
+        for (size_t range = 0; range < accel.numRanges && selfLoops; ++range)
+        {
+            for (size_t byte = accel.lo[range]; byte <= accel.hi[range]; ++byte)
+            {
+                selfLoops &= (table_[state * header_.numClasses + classes_[byte]] == state);
+            }
+        }
+    }
+    ENSURES_THROW(selfLoops, std::format("Invalid acceleration in dfa image '{}'", path));
+}
+
+DFA::Tables DFAImage::View() const
+{
+    return DFA::Tables{
+        .table = table_,
+        .classes = classes_,
+        .tags = tags_,
+        .accels = accels_,
+        .numClasses = header_.numClasses,
+        .start = header_.start,
+        .dead = header_.dead
+    };
+}
+
+size_t DFAImage::NumStates() const
+{
+    return header_.numStates;
+}
+
+std::string_view DFAImage::Rules() const
+{
+    return std::string_view(rules_, header_.rulesSize);
+}
+
+uint32_t DFAImage::Checksum(const uint32_t *words, size_t count)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count; ++i)
+    {
+        hash = (hash ^ words[i]) * 16777619u;
+    }
+    return hash;
+}
+
+size_t DFAImage::ImageSize(size_t numStates, size_t numClasses, size_t rulesSize)
+{
+    const size_t paddedRules = (rulesSize + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+    return sizeof(Header) + 256 + numStates * (sizeof(uint32_t) + sizeof(DFA::Accel)) +
+        numStates * numClasses * sizeof(uint32_t) + paddedRules;
+}
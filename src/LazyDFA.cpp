@@ -0,0 +1,226 @@
+/// @file LazyDFA.cpp
+/// @brief Provides the definitions for the LazyDFA class
+
+#include "LazyDFA.hpp"
+
+#include "NFA.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+
+LazyDFA::LazyDFA(const NFA &nfa, size_t maxStates)
+    : nfa_(nfa), classes_{}, numClasses_(0), classFirst_(), closures_(nfa_.EpsilonClosures()), 
+      maxStates_(maxStates), start_(UNKNOWN), table_(), tags_(), setOf_(), stateOf_(), 
+      mark_(nfa_.NumStates(), 0), generation_(0), scratch_(), bytesSinceFlush_(0), 
+      builtSinceFlush_(0), thrashingFlushes_(0), statesBuilt_(0), flushes_(0), fellBack_(false), 
+      fallback_()
+{
+    EXPECTS_THROW(maxStates >= 2, "Lazy dfa cache must hold at least 2 states");
+    const size_t N = nfa_.NumStates();
+    ENSURES_THROW(N < DEAD, "NFA state count exceeds the lazy dfa index range");
+
+    /// the bytes of a class label the same edges, so an edge range holds a class
+    /// exactly when it holds the first byte of the class. Class 0 labels nothing,
+    /// and no move is ever made on it
+    ///
+    numClasses_ = DFA::ClassesOf(nfa_, classes_);
+    classFirst_.assign(numClasses_, 0);
+    for (size_t byte = classes_.size(); byte-- > 0;)
+    {
+        classFirst_[classes_[byte]] = static_cast<uint8_t>(byte);
+    }
+}
+
+Token LazyDFA::MunchAt(std::string_view input, size_t offset)
+{
+    if (!fellBack_ && Thrashing()) FallBack();
+    if (fellBack_)
+    {
+        return fallback_->MunchAt(input, offset);
+    }
+
+    /// the start state accepting is ignored, as a token can never be empty
+    ///
+    uint32_t state = Start();
+    uint32_t matchTag = DFA::NO_TAG;
+    size_t matchLength = 0;
+    size_t i = offset;
+    size_t counted = offset; /// bytes up to here are in bytesSinceFlush_
+    for (; i < input.size(); ++i)
+    {
+        const uint8_t symbolClass = classes_[static_cast<uint8_t>(input[i])];
+        uint32_t next = table_[state * numClasses_ + symbolClass];
+        if (next == UNKNOWN)
+        {
+            bytesSinceFlush_ += i - counted;
+            counted = i;
+            next = Next(state, symbolClass);
+
+            /// the vm cannot resume a munch, so it redoes this one
+            ///
+            if (Thrashing())
+            {
+                FallBack();
+                return fallback_->MunchAt(input, offset);
+            }
+        }
+        if (next == DEAD) break;
+
+        state = next;
+        if (tags_[state] != DFA::NO_TAG)
+        {
+            matchTag = tags_[state];
+            matchLength = i + 1 - offset;
+        }
+    }
+    bytesSinceFlush_ += i - counted;
+
+    /// no case matched, skip a single byte
+    ///
+    if (matchLength == 0)
+    {
+        return Token{ .caseTag = NO_CASE_TAG, .offset = offset, .length = 1 };
+    }
+    return Token{ .caseTag = matchTag, .offset = offset, .length = matchLength };
+}
+
+std::vector<Token> LazyDFA::Tokenize(std::string_view input)
+{
+    std::vector<Token> tokens;
+    for (size_t offset = 0; offset < input.size(); offset += tokens.back().length)
+    {
+        tokens.push_back(MunchAt(input, offset));
+    }
+    return tokens;
+}
+
+auto LazyDFA::Statistics() const -> Stats
+{
+    return Stats{ .statesBuilt = statesBuilt_, .flushes = flushes_, .fellBack = fellBack_ };
+}
+
+size_t LazyDFA::SetHash::operator()(const std::vector<uint32_t> &set) const
+{
+    return boost::hash_range(set.begin(), set.end());
+}
+
+uint32_t LazyDFA::Start()
+{
+    if (start_ != UNKNOWN) return start_;
+
+    scratch_.assign(closures_.states.begin() + closures_.begin[nfa_.start], 
+        closures_.states.begin() + closures_.begin[nfa_.start + 1]);
+    std::ranges::sort(scratch_);
+    const uint32_t start = StateOf(scratch_);
+    start_ = start; /// set after StateOf, which may have flushed
+    return start_;
+}
+
+uint32_t LazyDFA::Next(uint32_t state, uint8_t symbolClass)
+{
+    /// move the nfa states of the state on the class, and close the result
+    ///
+    if (++generation_ == 0)
+    {
+        std::ranges::fill(mark_, 0);
+        generation_ = 1;
+    }
+    scratch_.clear();
+    const uint8_t byte = classFirst_[symbolClass];
+    for (uint32_t nfaState : *setOf_[state])
+    {
+        for (uint32_t t = nfa_.symbolBegin[nfaState]; t < nfa_.symbolBegin[nfaState + 1]; ++t)
+        {
+            if (nfa_.symbolLo[t] > byte) break; /// edges are sorted by range
+            if (nfa_.symbolHi[t] < byte) continue;
+            const uint32_t target = nfa_.symbolTargets[t];
+            for (uint32_t c = closures_.begin[target]; c < closures_.begin[target + 1]; ++c)
+            {
+                const uint32_t member = closures_.states[c];
+                if (mark_[member] == generation_) continue;
+                mark_[member] = generation_;
+                scratch_.push_back(member);
+            }
+        }
+    }
+    std::ranges::sort(scratch_);
+
+    /// a flush drops the state moved from, so its row is not filled in
+    ///
+    const size_t flushes = flushes_;
+    const uint32_t next = StateOf(scratch_);
+    if (flushes_ == flushes)
+    {
+        table_[state * numClasses_ + symbolClass] = next;
+    }
+    return next;
+}
+
+uint32_t LazyDFA::StateOf(const std::vector<uint32_t> &set)
+{
+    if (set.empty()) return DEAD;
+    if (auto it = stateOf_.find(set); it != stateOf_.end()) return it->second;
+
+    if (setOf_.size() == maxStates_)
+    {
+        Flush();
+    }
+
+    const uint32_t state = static_cast<uint32_t>(setOf_.size());
+    auto [it, inserted] = stateOf_.emplace(set, state);
+    setOf_.push_back(&it->first);
+
+    uint32_t tag = DFA::NO_TAG;
+    for (uint32_t nfaState : set)
+    {
+        tag = std::min(tag, nfa_.tags[nfaState]);
+    }
+    tags_.push_back(tag);
+
+    /// class 0 labels no transition, so it is known to die
+    ///
+    table_.resize(table_.size() + numClasses_, UNKNOWN);
+    table_[state * numClasses_] = DEAD;
+
+    ++statesBuilt_;
+    ++builtSinceFlush_;
+    return state;
+}
+
+void LazyDFA::Flush()
+{
+    /// states rebuilt faster than the input uses them means the cache is too
+    /// small for the input, and the vm is the better engine
+    ///
+    const bool thrashing = (bytesSinceFlush_ < MIN_BYTES_PER_STATE * builtSinceFlush_);
+    thrashingFlushes_ = (thrashing ? thrashingFlushes_ + 1 : 0);
+
+    ++flushes_;
+    start_ = UNKNOWN;
+    table_.clear();
+    tags_.clear();
+    setOf_.clear();
+    stateOf_.clear();
+    bytesSinceFlush_ = 0;
+    builtSinceFlush_ = 0;
+}
+
+void LazyDFA::FallBack()
+{
+    TRACE(INFO, "Lazy dfa cache thrashing, falling back to the PikeVM" << std::endl);
+    fellBack_ = true;
+    fallback_.emplace(std::move(nfa_));
+
+    /// the cache and the closures are never used again
+    ///
+    closures_ = {};
+    table_ = {};
+    tags_ = {};
+    setOf_ = {};
+    stateOf_ = {};
+    mark_ = {};
+    scratch_ = {};
+}
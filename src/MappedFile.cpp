@@ -0,0 +1,96 @@
+/// @file MappedFile.cpp
+/// @brief Provides the definitions for the MappedFile class
+
+#include "MappedFile.hpp"
+
+#include "LexerUtil/Macros.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const char *path)
+    : data_(nullptr), size_(0)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    ENSURES_THROW(fd >= 0, std::format("Could not open file '{}': {}", path, std::strerror(errno)));
+
+    struct stat info{ };
+    if (::fstat(fd, &info) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        THROW_ERR(std::format("Could not stat file '{}': {}", path, std::strerror(error)));
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    /// an empty file cannot be mapped, it is represented by an empty view
+    ///
+    if (size_ > 0)
+    {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        ::close(fd); /// the mapping keeps its own reference to the file
+        ENSURES_THROW(data != MAP_FAILED,
+            std::format("Could not map file '{}': {}", path, std::strerror(error)));
+        data_ = data;
+
+        /// the advice is only a hint, so failures are ignored
+        ///
+        (void)::madvise(data_, size_, MADV_SEQUENTIAL);
+        (void)::madvise(data_, size_, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        (void)::madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+    }
+    else
+    {
+        ::close(fd);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+{ }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        Unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+std::string_view MappedFile::View() const
+{
+    if (data_ == nullptr) return { };
+    return std::string_view{ static_cast<const char*>(data_), size_ };
+}
+
+size_t MappedFile::Size() const
+{
+    return size_;
+}
+
+void MappedFile::Unmap()
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
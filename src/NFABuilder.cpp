@@ -3,6 +3,7 @@
 
 #include "NFABuilder.hpp"
 
+#include "Counters.hpp"
 #include "NFA.hpp"
 #include "RuleCase.hpp"
 
@@ -19,15 +20,15 @@
 
 NFA NFABuilder::Build(std::vector<RuleCase> ruleCases)
 {
-    NFA ret { 
-        .start = INVALID_STATE_INDEX,
-        .accept = {},
-        .states = {},
-        .numCases = ruleCases.size()
-    };
-
-    std::vector<Fragment> fragments;
-    fragments.reserve(ruleCases.size());
+    /// every state is made for a character of a pattern, other than the start
+    /// and the accepting state of each case
+    ///
+    size_t maxStates = ruleCases.size() + 1;
+    for (const RuleCase& ruleCase : ruleCases)
+    {
+        maxStates += ruleCase.patternData.size();
+    }
+    NFA ret = NewNFA(maxStates, ruleCases.size());
 
     size_t ruleNo = 0;
     size_t startIndex = ret.start = NewState(ret.states, ruleCases.size());
@@ -35,12 +36,22 @@ NFA NFABuilder::Build(std::vector<RuleCase> ruleCases)
     for (RuleCase& ruleCase : ruleCases)
     {
         PreProcessor::PreProcess(ruleCase);
-        Fragment frag{ };
+        Fragment frag{ .startIndex = INVALID_STATE_INDEX, .holes = {} };
         BuildFragment(ruleCase, ret.states, frag);
-        size_t caseIndex = ConcludeCase(ruleNo++, frag, ret.states, ret.accept);
-        ret.states[startIndex].transitions.emplace_back(EPSILON, caseIndex);
+
+        /// a case without a pattern (NONE, END_OF_FILE) matches no input, so it
+        /// gets no accepting state and is not reached from the start
+        ///
+        if (frag.startIndex == INVALID_STATE_INDEX)
+        {
+            ++ruleNo;
+            continue;
+        }
+        size_t caseIndex = ConcludeCase(ruleNo++, std::move(frag), ret.states, ret.accept);
+        ret.states[startIndex].transitions.emplace_back(EPSILON, EPSILON, caseIndex);
     }
 
+    Counters::Add(Counters::Counter_t::NFA_STATES, ret.states.size());
     return ret;
 }
 
@@ -49,23 +60,30 @@ NFA NFABuilder::Build(std::vector<RuleCase> ruleCases)
 template <Regex::ItOrder it>
 NFA NFABuilder::Build(const std::vector<Regex::Flat::Type>& exprs)
 {
-    NFA ret {
-        .start = INVALID_STATE_INDEX,
-        .accept = {},
-        .states = {},
-        .numCases = exprs.size()
-    };
+    /// every state is made for a character of an expression, other than the start
+    /// and the accepting state of each case
+    ///
+    size_t maxStates = exprs.size() + 1;
+    for (const Regex::Flat::Type& expr : exprs)
+    {
+        for (const Regex::Flat::Symbol& sym : expr)
+        {
+            const auto* literal = std::get_if<Regex::Flat::Literal_t>(&sym);
+            maxStates += (literal ? literal->value.size() : 1);
+        }
+    }
+    NFA ret = NewNFA(maxStates, exprs.size());
 
     ret.start = NewState(ret.states, exprs.size());
 
-    std::vector<Fragment> frags; frags.reserve(exprs.size());
     for (const auto& [ruleNo, expr] : std::views::enumerate(exprs))
     {
         Fragment ruleFrag = BuildFragment<it>(expr, ret.states);
-        size_t caseIndex = ConcludeCase(ruleNo, ruleFrag, ret.states, ret.accept);
-        ret.states[ret.start].transitions.emplace_back(EPSILON, caseIndex);
+        size_t caseIndex = ConcludeCase(ruleNo, std::move(ruleFrag), ret.states, ret.accept);
+        ret.states[ret.start].transitions.emplace_back(EPSILON, EPSILON, caseIndex);
     }
 
+    Counters::Add(Counters::Counter_t::NFA_STATES, ret.states.size());
     return ret;
 }
 
@@ -85,11 +103,11 @@ template NFA NFABuilder::Build<Regex::ItOrder::POST>(const std::vector<Regex::Fl
 /// @brief Post-order implementation of BuildFragment
 template <>
 auto NFABuilder::BuildFragment<Regex::ItOrder::POST>(const Regex::Flat::Type &expr, 
-    std::vector<NFA::State> &states) -> Fragment
+    std::pmr::vector<NFA::State> &states) -> Fragment
 {
     using namespace Regex::Flat;
     
-    std::stack<Fragment> fragments;
+    FragmentStack fragments{ std::pmr::vector<Fragment>(states.get_allocator()) };
 
     for (const Symbol& sym : expr)
     {
@@ -118,30 +136,30 @@ auto NFABuilder::BuildFragment<Regex::ItOrder::POST>(const Regex::Flat::Type &ex
                 {
                     Fragment right = pop(fragments);
                     Fragment left = pop(fragments);
-                    return ApplyUnion(left, right, states);
+                    return ApplyUnion(std::move(left), std::move(right), states);
                 }
                 else if constexpr (std::is_same_v<T, Concat_t>)
                 {
                     Fragment right = pop(fragments);
                     Fragment left = pop(fragments);
-                    return ApplyCat(left, right, states);
+                    return ApplyCat(std::move(left), std::move(right), states);
                 }
                 else if constexpr (std::is_same_v<T, KleeneStar_t>)
                 {
                     Fragment frag = pop(fragments);
-                    return ApplyKStar(frag, states);
+                    return ApplyKStar(std::move(frag), states);
                 }
             }, sym)
         );
     }
     ENSURES_THROW(fragments.size() == 1, "Unexpected additional fragments in postorder evaluation");
-    return fragments.top();
+    return pop(fragments);
 }
 
 /// @brief Pre-order implementation of BuildFragment
 template <>
 auto NFABuilder::BuildFragment<Regex::ItOrder::PRE>(const Regex::Flat::Type &expr, 
-    std::vector<NFA::State> &states) -> Fragment
+    std::pmr::vector<NFA::State> &states) -> Fragment
 {
     ENSURES_THROW(false, "Unimplemented");
 }
@@ -149,7 +167,7 @@ auto NFABuilder::BuildFragment<Regex::ItOrder::PRE>(const Regex::Flat::Type &exp
 /// @brief In-order implementation of BuildFragment
 template <>
 auto NFABuilder::BuildFragment<Regex::ItOrder::IN>(const Regex::Flat::Type &expr, 
-    std::vector<NFA::State> &states) -> Fragment
+    std::pmr::vector<NFA::State> &states) -> Fragment
 {
     ENSURES_THROW(false, "Unimplemented");
 }
@@ -158,72 +176,118 @@ auto NFABuilder::BuildFragment<Regex::ItOrder::IN>(const Regex::Flat::Type &expr
 /// New state / fragment management methods
 /// -----------------------------------------------------------------------------------------------
 
-size_t NFABuilder::NewState(std::vector<NFA::State> &nfaStates, size_t caseNo, size_t estTCount)
+NFA NFABuilder::NewNFA(size_t maxStates, size_t numCases)
+{
+    /// the first block holds the states, and about a transition and a fragment each
+    ///
+    auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>(
+        maxStates * (sizeof(NFA::State) + sizeof(NFA::Transition) + sizeof(Fragment)),
+        Counters::Resource());
+    NFA ret {
+        .arena = arena,
+        .start = INVALID_STATE_INDEX,
+        .accept = {},
+        .states = std::pmr::vector<NFA::State>(arena.get()),
+        .numCases = numCases
+    };
+    ret.states.reserve(maxStates);
+    return ret;
+}
+
+size_t NFABuilder::NewState(std::pmr::vector<NFA::State> &nfaStates, size_t caseNo, size_t estTCount)
 {
     size_t stateIndex = nfaStates.size();
-    nfaStates.emplace_back(stateIndex, caseNo, std::vector<NFA::Transition>{});
+    nfaStates.emplace_back(stateIndex, caseNo, 
+        std::pmr::vector<NFA::Transition>(nfaStates.get_allocator()));
     nfaStates.back().transitions.reserve(estTCount);
     return stateIndex;
 }
 
-size_t NFABuilder::NewState(std::vector<NFA::State>& nfaStates, size_t estTCount)
+size_t NFABuilder::NewState(std::pmr::vector<NFA::State>& nfaStates, size_t estTCount)
 {
     return NewState(nfaStates, NO_CASE_TAG, estTCount);
 }
 
-void NFABuilder::PatchHoles(const std::vector<Fragment::Hole> &holes, 
-    size_t patchState, std::vector<NFA::State> &nfaStates)
+void NFABuilder::PatchHoles(Fragment::PatchList&& holes, 
+    size_t patchState, std::pmr::vector<NFA::State> &nfaStates)
 {
-    DBG << "PatchHoles(holes, " << patchState << ")\n";
-    for (const auto& hole : holes)
+    TRACE(DEBUG, "PatchHoles(holes, " << patchState << ")\n");
+    for (size_t hole = std::exchange(holes.head, NO_HOLE); hole != NO_HOLE;)
     {
-        DBG << "    " << hole.holeIndex << "['" << hole.tVal << "'] = " << patchState << "\n"; 
-        nfaStates[hole.holeIndex].transitions.emplace_back(hole.tVal, patchState);
+        NFA::Transition& transition = TransitionOf(hole, nfaStates);
+        TRACE(VERBOSE, "    " << (hole >> HOLE_SLOT_BITS) << "['" << transition.lo << "'-'" 
+            << transition.hi << "'] = " << patchState << "\n");
+        hole = std::exchange(transition.to, patchState);
     }
+    holes.tail = NO_HOLE;
+}
+
+auto NFABuilder::NewHole(size_t stateIndex, char lo, char hi, 
+    std::pmr::vector<NFA::State> &nfaStates) -> Fragment::PatchList
+{
+    std::pmr::vector<NFA::Transition>& transitions = nfaStates[stateIndex].transitions;
+    EXPECTS_THROW(stateIndex >> HOLE_SLOT_BITS == 0 && transitions.size() >> HOLE_SLOT_BITS == 0,
+        "NFA too large to address its holes");
+
+    const size_t hole = (stateIndex << HOLE_SLOT_BITS) | transitions.size();
+    transitions.emplace_back(lo, hi, NO_HOLE);
+    return Fragment::PatchList(hole, hole);
+}
+
+auto NFABuilder::Splice(Fragment::PatchList &&left, Fragment::PatchList &&right, 
+    std::pmr::vector<NFA::State> &nfaStates) -> Fragment::PatchList
+{
+    if (left.Empty()) return std::move(right);
+    if (right.Empty()) return std::move(left);
+
+    /// link the end of left to the start of right
+    ///
+    TransitionOf(left.tail, nfaStates).to = right.head;
+    Fragment::PatchList ret(std::exchange(left.head, NO_HOLE), std::exchange(right.tail, NO_HOLE));
+    left.tail = right.head = NO_HOLE;
+    return ret;
 }
 
-auto NFABuilder::MakeChar(char a, std::vector<NFA::State> &nfaStates)
+NFA::Transition& NFABuilder::TransitionOf(size_t hole, std::pmr::vector<NFA::State> &nfaStates)
+{
+    const size_t slotMask = (size_t{ 1 } << HOLE_SLOT_BITS) - 1;
+    return nfaStates[hole >> HOLE_SLOT_BITS].transitions[hole & slotMask];
+}
+
+auto NFABuilder::MakeChar(char a, std::pmr::vector<NFA::State> &nfaStates)
     -> NFABuilder::Fragment
 {
     size_t q0 = NewState(nfaStates, 1);
     
     return Fragment{
         .startIndex = q0, 
-        .holes = { 
-            Fragment::Hole{
-                .holeIndex = q0,
-                .tVal = a
-            } 
-        } 
+        .holes = NewHole(q0, a, a, nfaStates)
     };
 }
 
-auto NFABuilder::MakeCharset(char lo, char hi, bool inverted, std::vector<NFA::State> &nfaStates) 
+auto NFABuilder::MakeCharset(char lo, char hi, bool inverted, std::pmr::vector<NFA::State> &nfaStates) 
     -> Fragment
 {
-    // get the range of lo-hi and it's size
-    auto range = std::views::iota(lo, hi+1);
-    size_t rangeSize = std::ranges::size(range);
-
-    // make the new state and fragment
-    size_t q0 = NewState(nfaStates, rangeSize);
-    Fragment ret {
-        .startIndex = q0,
-        .holes = {}
-    };
-    ret.holes.reserve(rangeSize);
+    // an inverted range is the rest of the alphabet
+    CharClass range = CharClass::Range(static_cast<uint8_t>(lo), static_cast<uint8_t>(hi));
+    return MakeClass(inverted ? range.NegatedIn(ALPHABET_CLASS) : range, nfaStates);
+}
 
-    // fill in the holes
-    for (char c : range)
-    {
-        ret.holes.emplace_back(q0, c);
-    }
+auto NFABuilder::MakeClass(const CharClass &charClass, std::pmr::vector<NFA::State> &nfaStates)
+    -> Fragment
+{
+    size_t q0 = NewState(nfaStates, 1);
+    Fragment ret{ .startIndex = q0, .holes = {} };
 
-    // return range fragment
+    charClass.ForEachRange([&](uint8_t lo, uint8_t hi)
+    {
+        ret.holes = Splice(std::move(ret.holes), 
+            NewHole(q0, static_cast<char>(lo), static_cast<char>(hi), nfaStates), nfaStates);
+    });
     return ret;
 }
 
-auto NFABuilder::MakeLiteral(std::string_view string, std::vector<NFA::State> &nfaStates) 
+auto NFABuilder::MakeLiteral(std::string_view string, std::pmr::vector<NFA::State> &nfaStates) 
     -> Fragment
 {
     /// make sure the string isnt "" (doesnt make sense)
@@ -232,59 +296,53 @@ auto NFABuilder::MakeLiteral(std::string_view string, std::vector<NFA::State> &n
     /// initialize 
     size_t index = 0;
     Fragment first = MakeChar(string[index], nfaStates);
-    Fragment curr{ };
 
     /// perform concatination over the literal
     for (++index; index < string.size(); ++index)
     {
-        curr = MakeChar(string[index], nfaStates);
-        first = ApplyCat(first, curr, nfaStates);
+        first = ApplyCat(std::move(first), MakeChar(string[index], nfaStates), nfaStates);
     }
 
     /// return the first fragment (which we continously applied concat to)
     return first;
 }
 
-auto NFABuilder::ApplyCat(const Fragment &left, const Fragment &right,
-    std::vector<NFA::State>& nfaStates) -> Fragment
+auto NFABuilder::ApplyCat(Fragment &&left, Fragment &&right,
+    std::pmr::vector<NFA::State>& nfaStates) -> Fragment
 {
-    PatchHoles(left.holes, right.startIndex, nfaStates);    
-    return Fragment{left.startIndex, right.holes };
+    PatchHoles(std::move(left.holes), right.startIndex, nfaStates);    
+    return Fragment{ .startIndex = left.startIndex, .holes = std::move(right.holes) };
 }
 
-auto NFABuilder::ApplyUnion(const Fragment &left, const Fragment &right,
-    std::vector<NFA::State>& nfaStates) -> Fragment
+auto NFABuilder::ApplyUnion(Fragment &&left, Fragment &&right,
+    std::pmr::vector<NFA::State>& nfaStates) -> Fragment
 {
     /// add a new state and perform the union on the fragments
     ///
     size_t newStateIndex = NewState(nfaStates, 2);
     nfaStates[newStateIndex].transitions = {
         NFA::Transition{
-            .symbol = EPSILON,
+            .lo = EPSILON,
+            .hi = EPSILON,
             .to = left.startIndex
         },
         NFA::Transition{
-            .symbol = EPSILON,
+            .lo = EPSILON,
+            .hi = EPSILON,
             .to = right.startIndex
         }
     };
 
-    Fragment ret{
+    /// splice the holes of both fragments into the new fragment & return
+    ///
+    return Fragment{
         .startIndex = newStateIndex,
-        .holes = {}
+        .holes = Splice(std::move(left.holes), std::move(right.holes), nfaStates)
     };
-
-    /// insert the holes of both fragments into the new fragment & return
-    ///
-    ret.holes.reserve(left.holes.size() + right.holes.size());
-    ret.holes.insert(ret.holes.end(), left.holes.begin(), left.holes.end());
-    ret.holes.insert(ret.holes.end(), right.holes.begin(), right.holes.end());
-    
-    return ret;
 }
 
-auto NFABuilder::ApplyKStar(const Fragment &fragment, 
-    std::vector<NFA::State> &nfaStates) -> Fragment
+auto NFABuilder::ApplyKStar(Fragment &&fragment, 
+    std::pmr::vector<NFA::State> &nfaStates) -> Fragment
 {
     size_t newStateIndex = NewState(nfaStates, 2);
 
@@ -293,42 +351,38 @@ auto NFABuilder::ApplyKStar(const Fragment &fragment,
     ///
     nfaStates[newStateIndex].transitions = {
         NFA::Transition{
-            .symbol = EPSILON,
+            .lo = EPSILON,
+            .hi = EPSILON,
             .to = fragment.startIndex
         }
     };
 
     /// patch the holes of the fragment
     ///
-    PatchHoles(fragment.holes, newStateIndex, nfaStates);
+    PatchHoles(std::move(fragment.holes), newStateIndex, nfaStates);
     
     return Fragment{
         .startIndex = newStateIndex,
-        .holes = {
-            Fragment::Hole{
-                .holeIndex = fragment.startIndex,
-                .tVal = EPSILON
-            }
-        } 
+        .holes = NewHole(fragment.startIndex, EPSILON, EPSILON, nfaStates)
     };
 }
 
-auto NFABuilder::ApplyKPlus(const Fragment &fragment, 
-    std::vector<NFA::State> &nfaStates) -> Fragment
+auto NFABuilder::ApplyKPlus(Fragment &&fragment, 
+    std::pmr::vector<NFA::State> &nfaStates) -> Fragment
 {
     (void)fragment; (void)nfaStates;
     THROW_ERR("Unimplemented '+' operator");
 }
 
-auto NFABuilder::ApplyKOpt(const Fragment& fragment,
-    std::vector<NFA::State> &nfaStates) -> Fragment
+auto NFABuilder::ApplyKOpt(Fragment&& fragment,
+    std::pmr::vector<NFA::State> &nfaStates) -> Fragment
 {
     (void)fragment; (void)nfaStates;
     THROW_ERR("Unimplemented '?' operator");
 }
 
-auto NFABuilder::ApplyOperator(PreProcessor::Operator_t op, std::stack<Fragment> &fragStack,
-    std::vector<NFA::State>& nfaStates) -> Fragment
+auto NFABuilder::ApplyOperator(PreProcessor::Operator_t op, FragmentStack &fragStack,
+    std::pmr::vector<NFA::State>& nfaStates) -> Fragment
 {
     using enum PreProcessor::Operator_t;
     switch ( op )
@@ -337,42 +391,42 @@ auto NFABuilder::ApplyOperator(PreProcessor::Operator_t op, std::stack<Fragment>
     {
         Fragment right = pop(fragStack);
         Fragment left = pop(fragStack);
-        DBG << "Applying Union operator to";
-        Debug(left);
-        DBG << "and ";
-        Debug(right);
-        return ApplyUnion(left, right, nfaStates);
+        TRACE(DEBUG, "Applying Union operator to");
+        TRACE_DO(DEBUG, Debug(left));
+        TRACE(DEBUG, "and ");
+        TRACE_DO(DEBUG, Debug(right));
+        return ApplyUnion(std::move(left), std::move(right), nfaStates);
     }
     case CONCAT:
     {
         Fragment right = pop(fragStack);
         Fragment left = pop(fragStack);
-        DBG << "Applying Concat operator to";
-        Debug(left);
-        DBG << "and ";
-        Debug(right);
-        return ApplyCat(left,right,nfaStates);
+        TRACE(DEBUG, "Applying Concat operator to");
+        TRACE_DO(DEBUG, Debug(left));
+        TRACE(DEBUG, "and ");
+        TRACE_DO(DEBUG, Debug(right));
+        return ApplyCat(std::move(left), std::move(right), nfaStates);
     }
     case KSTAR:
     {
         Fragment a = pop(fragStack);
-        DBG << "Applying KSTAR operator to";
-        Debug(a);
-        return ApplyKStar(a, nfaStates);
+        TRACE(DEBUG, "Applying KSTAR operator to");
+        TRACE_DO(DEBUG, Debug(a));
+        return ApplyKStar(std::move(a), nfaStates);
     }
     case KPLUS:
     {
         Fragment a = pop(fragStack);
-        DBG << "Applying KPLUS operator to";
-        Debug(a);
-        return ApplyKPlus(a, nfaStates);
+        TRACE(DEBUG, "Applying KPLUS operator to");
+        TRACE_DO(DEBUG, Debug(a));
+        return ApplyKPlus(std::move(a), nfaStates);
     }
     case OPTIONAL:
     {
         Fragment a = pop(fragStack);
-        DBG << "Applying OPTIONAL operator to";
-        Debug(a);
-        return ApplyKOpt(a, nfaStates);
+        TRACE(DEBUG, "Applying OPTIONAL operator to");
+        TRACE_DO(DEBUG, Debug(a));
+        return ApplyKOpt(std::move(a), nfaStates);
     }
     default: THROW_ERR("Unhandled case in NFABuilder::ApplyOperator()");
     }
@@ -380,7 +434,7 @@ auto NFABuilder::ApplyOperator(PreProcessor::Operator_t op, std::stack<Fragment>
 }
 
 void NFABuilder::BuildFragment(const RuleCase &pattern,  
-    std::vector<NFA::State>& nfaStates, Fragment &fragment)
+    std::pmr::vector<NFA::State>& nfaStates, Fragment &fragment)
 {
     /// use shunting yard if the pattern is a regex
     /// 
@@ -404,16 +458,15 @@ void NFABuilder::BuildFragment(const RuleCase &pattern,
     fragment = MakeChar(literalView[0], nfaStates);
     for (size_t i = 1; i <literalView.size();++i)
     {
-        Fragment right = MakeChar(literalView[i], nfaStates);
-        fragment = ApplyCat(fragment,right,nfaStates);
+        fragment = ApplyCat(std::move(fragment), MakeChar(literalView[i], nfaStates), nfaStates);
     }
 }
 
-size_t NFABuilder::ConcludeCase(size_t ruleNo, Fragment &ruleFragment, std::vector<NFA::State> &nfaStates, 
+size_t NFABuilder::ConcludeCase(size_t ruleNo, Fragment &&ruleFragment, std::pmr::vector<NFA::State> &nfaStates, 
     std::unordered_set<size_t> &nfaAccepting)
 {
     size_t acceptState = NewState(nfaStates, ruleNo, 1);
-    PatchHoles(ruleFragment.holes, acceptState, nfaStates);
+    PatchHoles(std::move(ruleFragment.holes), acceptState, nfaStates);
     nfaAccepting.insert(acceptState);
     return ruleFragment.startIndex;
 }
@@ -421,26 +474,36 @@ size_t NFABuilder::ConcludeCase(size_t ruleNo, Fragment &ruleFragment, std::vect
 #include <iomanip>
 
 void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
-    std::vector<NFA::State>& nfaStates)
+    std::pmr::vector<NFA::State>& nfaStates)
 {
     bool expectOperand = true; /// true if we expect an operand next, false if we expect an operator next
     std::stack<PreProcessor::Operator_t> opStack; /// stack to hold operators
-    std::stack<Fragment> fragStack; /// stack to hold fragments
+    FragmentStack fragStack{ std::pmr::vector<Fragment>(nfaStates.get_allocator()) }; /// stack to hold fragments
     std::string_view pattern = ruleCase.patternData;
     
     /// iterate over the pattern, and convert to RPN using the shunting-yard algorithm
     ///
-    for (char c : pattern) 
+    for (size_t i = 0; i < pattern.size(); ++i) 
     {
-        DBG << "ShuntingYard pass: 0x" << std::setfill('0')  
-            << std::hex << (int)c << std::setfill(' ') << std::dec << std::endl; 
+        char c = pattern[i];
+        TRACE(VERBOSE, "ShuntingYard pass: 0x" << std::setfill('0')  
+            << std::hex << (int)c << std::setfill(' ') << std::dec << std::endl);
 
-        if (!PreProcessor::IsOperator(c))
+        if (PreProcessor::IsClass(c))
+        {
+            EXPECTS_THROW(expectOperand, "Expected literal, got a class");
+            fragStack.push(MakeClass(PreProcessor::ClassAt(pattern, i), nfaStates));
+            TRACE(DEBUG, "Pushed Class Fragment ");
+            TRACE_DO(DEBUG, Debug(fragStack.top()));
+            i += PreProcessor::CLASS_SIZE - 1; /// skip to the end of the class
+            expectOperand = false;
+        }
+        else if (!PreProcessor::IsOperator(c))
         {
             EXPECTS_THROW(expectOperand, std::format("Expected literal, got '{}'", c));
             fragStack.push(MakeChar(c, nfaStates));
-            DBG << "Pushed Literal Fragment ";
-            Debug(fragStack.top());
+            TRACE(DEBUG, "Pushed Literal Fragment ");
+            TRACE_DO(DEBUG, Debug(fragStack.top()));
             expectOperand = false;
         }
         else
@@ -450,14 +513,14 @@ void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
             {
             case PreProcessor::Operator_t::LPAREN: 
             {
-                DBG << "Found LPAREN" << std::endl;
+                TRACE(DEBUG, "Found LPAREN" << std::endl);
                 opStack.push(PreProcessor::Operator_t::LPAREN);
                 expectOperand = true;
                 break;
             }
             case PreProcessor::Operator_t::RPAREN:
             {
-                DBG << "Found RPAREN" << std::endl;
+                TRACE(DEBUG, "Found RPAREN" << std::endl);
                 EXPECTS_THROW(!expectOperand, "TODO: Unkerr?");
 
                 /// pop off the stack until we find a left paren
@@ -467,8 +530,8 @@ void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
                 {
                     PreProcessor::Operator_t op = pop(opStack);
                     fragStack.push(ApplyOperator(op, fragStack, nfaStates));
-                    DBG << "Pushed ";
-                    Debug(fragStack.top());
+                    TRACE(DEBUG, "Pushed ");
+                    TRACE_DO(DEBUG, Debug(fragStack.top()));
                 }
                 ENSURES_THROW(!opStack.empty() && opStack.top() == PreProcessor::Operator_t::LPAREN, "TODO: UNKERR?");
                 
@@ -478,7 +541,7 @@ void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
             }
             default:
             {
-                DBG << "Found an operator" << std::endl;
+                TRACE(DEBUG, "Found an operator" << std::endl);
                 EXPECTS_THROW(!expectOperand, "Unexpected operator");
 
                 /// pop off the stack until we find a lower precedence operator or a left paren or empty
@@ -490,8 +553,8 @@ void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
                 {
                     PreProcessor::Operator_t op2 = pop(opStack);
                     fragStack.push(ApplyOperator(op2, fragStack, nfaStates));
-                    DBG << "Pushed ";
-                    Debug(fragStack.top());
+                    TRACE(DEBUG, "Pushed ");
+                    TRACE_DO(DEBUG, Debug(fragStack.top()));
                 }
 
                 opStack.push(op);
@@ -512,7 +575,7 @@ void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
     }
     ENSURES_THROW(fragStack.size() == 1, "TODO: UNKERR?");
 
-    fragment = std::move(fragStack.top());
+    fragment = pop(fragStack);
 }
 
 /// -----------------------------------------------------------------------------------------------
@@ -521,13 +584,15 @@ void NFABuilder::ShuntingYard(const RuleCase &ruleCase, Fragment &fragment,
 
 void NFABuilder::Debug(const Fragment &frag)
 {
-    DBG << "<Fragment " << &frag << ", startIndex=" << frag.startIndex
-        << ", holes=[";
-    for (const Fragment::Hole& hole : frag.holes)
+    std::cout << "<Fragment " << &frag << ", startIndex=" << frag.startIndex << ", holes=";
+    if (frag.holes.Empty())
     {
-        DBG << '(' << hole.holeIndex << ", \'"
-            << hole.tVal << "\') ";
+        std::cout << "[]>" << std::endl;
+        return;
     }
-    DBG << "]>" << std::endl;
+    const size_t slotMask = (size_t{ 1 } << HOLE_SLOT_BITS) - 1;
+    std::cout << "[(" << (frag.holes.head >> HOLE_SLOT_BITS) << ", " << (frag.holes.head & slotMask) 
+        << ") .. (" << (frag.holes.tail >> HOLE_SLOT_BITS) << ", " << (frag.holes.tail & slotMask) 
+        << ")]>" << std::endl;
 }
 
@@ -0,0 +1,257 @@
+/// @file NFAOptimizer.cpp
+/// @brief Provides the definitions for the NFAOptimizer class
+
+#include "NFAOptimizer.hpp"
+
+#include "Counters.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/// @brief a symbol transition of an epsilon-free state, (lo, hi, to)
+using Edge = std::tuple<char, char, size_t>;
+
+/// @brief find the strongly connected components of the epsilon graph of an nfa
+///        (Tarjan's algorithm, iterative so deep nfas cannot overflow the stack)
+/// @param nfa the nfa
+/// @param[out] componentOf the component of every state
+/// @return the number of components. Components are numbered in reverse
+///         topological order: every component reachable from c is numbered below c
+static size_t EpsilonComponents(const NFA& nfa, std::vector<size_t>& componentOf)
+{
+    const size_t N = nfa.states.size();
+    constexpr size_t UNVISITED = std::numeric_limits<size_t>::max();
+
+    std::vector<size_t> order(N, UNVISITED);
+    std::vector<size_t> low(N, 0);
+    std::vector<bool> onStack(N, false);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> calls; /// (state, next transition to visit)
+    componentOf.assign(N, UNVISITED);
+    size_t numVisited = 0;
+    size_t numComponents = 0;
+
+    for (size_t root = 0; root < N; ++root)
+    {
+        if (order[root] != UNVISITED) continue;
+
+        calls.emplace_back(root, 0);
+        while (!calls.empty())
+        {
+            auto& [state, next] = calls.back();
+            if (next == 0)
+            {
+                order[state] = low[state] = numVisited++;
+                stack.push_back(state);
+                onStack[state] = true;
+            }
+
+            /// visit the next unvisited epsilon successor, if any
+            ///
+            const std::pmr::vector<NFA::Transition>& transitions = nfa.states[state].transitions;
+            bool descended = false;
+            while (!descended && next < transitions.size())
+            {
+                const NFA::Transition& transition = transitions[next++];
+                if (!transition.IsEpsilon()) continue;
+                const size_t result = transition.to;
+                if (order[result] == UNVISITED)
+                {
+                    calls.emplace_back(result, 0);
+                    descended = true;
+                }
+                else if (onStack[result])
+                {
+                    low[state] = std::min(low[state], order[result]);
+                }
+            }
+            if (descended) continue;
+
+            /// every successor is done, so close the component if this is its root
+            ///
+            const size_t done = state;
+            if (low[done] == order[done])
+            {
+                size_t member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    componentOf[member] = numComponents;
+                } while (member != done);
+                ++numComponents;
+            }
+            calls.pop_back();
+            if (!calls.empty())
+            {
+                size_t parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[done]);
+            }
+        }
+    }
+    return numComponents;
+}
+
+NFA NFAOptimizer::RemoveEpsilons(const NFA &nfa)
+{
+    const size_t N = nfa.states.size();
+
+    /// the closures of the states of a component are the same, and contain the
+    /// closures of the components they reach, so the closed transitions and tag of
+    /// every component follow from its successors. Tarjan numbers components with
+    /// their successors first, so one pass in order propagates everything
+    ///
+    std::vector<size_t> componentOf;
+    const size_t numComponents = EpsilonComponents(nfa, componentOf);
+    std::vector<std::vector<size_t>> members(numComponents);
+    for (size_t stateI = 0; stateI < N; ++stateI)
+    {
+        members[componentOf[stateI]].push_back(stateI);
+    }
+
+    std::vector<std::vector<Edge>> edgesOf(numComponents);
+    std::vector<size_t> tagOf(numComponents, NO_CASE_TAG);
+    for (size_t component = 0; component < numComponents; ++component)
+    {
+        std::vector<Edge>& edges = edgesOf[component];
+        for (size_t stateI : members[component])
+        {
+            if (nfa.accept.contains(stateI))
+            {
+                tagOf[component] = std::min(tagOf[component], nfa.states[stateI].caseTag);
+            }
+            for (const auto& [lo, hi, result] : nfa.states[stateI].transitions)
+            {
+                if (lo != EPSILON)
+                {
+                    edges.emplace_back(lo, hi, result);
+                }
+                else if (componentOf[result] != component)
+                {
+                    const size_t successor = componentOf[result];
+                    edges.insert(edges.end(), edgesOf[successor].begin(), edgesOf[successor].end());
+                    tagOf[component] = std::min(tagOf[component], tagOf[successor]);
+                }
+            }
+        }
+        std::ranges::sort(edges);
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    }
+
+    /// only the start and the targets of symbol transitions are ever entered
+    /// without an epsilon move, so they are the states of the new nfa
+    ///
+    std::vector<bool> kept(N, false);
+    kept[nfa.start] = true;
+    for (const std::vector<Edge>& edges : edgesOf)
+    {
+        for (const auto& [lo, hi, result] : edges)
+        {
+            kept[result] = true;
+        }
+    }
+
+    /// merge states with the same tag and transitions (after earlier merges)
+    /// until nothing changes: their futures are identical
+    ///
+    std::vector<size_t> repOf(N);
+    for (size_t stateI = 0; stateI < N; ++stateI)
+    {
+        repOf[stateI] = stateI;
+    }
+    size_t numClasses = std::ranges::count(kept, true);
+    while (true)
+    {
+        std::map<std::pair<size_t, std::vector<Edge>>, size_t> classOfSignature;
+        std::vector<size_t> newRepOf(repOf);
+        for (size_t stateI = 0; stateI < N; ++stateI)
+        {
+            if (!kept[stateI]) continue;
+            const size_t component = componentOf[stateI];
+            std::vector<Edge> signature = edgesOf[component];
+            for (auto& [lo, hi, result] : signature)
+            {
+                result = repOf[result];
+            }
+            std::ranges::sort(signature);
+            signature.erase(std::unique(signature.begin(), signature.end()), signature.end());
+            auto [it, inserted] = classOfSignature.try_emplace(
+                std::make_pair(tagOf[component], std::move(signature)), stateI);
+            newRepOf[stateI] = it->second;
+        }
+        repOf = std::move(newRepOf);
+        if (classOfSignature.size() == numClasses) break;
+        numClasses = classOfSignature.size();
+    }
+
+    /// number the states reachable from the start breadth first
+    ///
+    const size_t UNNUMBERED = std::numeric_limits<size_t>::max();
+    std::vector<size_t> newIndexOf(N, UNNUMBERED);
+    std::vector<size_t> order;
+    auto Number = [&](size_t stateI)
+    {
+        if (newIndexOf[stateI] != UNNUMBERED) return;
+        newIndexOf[stateI] = order.size();
+        order.push_back(stateI);
+    };
+    Number(repOf[nfa.start]);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        for (const auto& [lo, hi, result] : edgesOf[componentOf[order[i]]])
+        {
+            Number(repOf[result]);
+        }
+    }
+
+    auto arena = std::make_shared<std::pmr::monotonic_buffer_resource>(
+        order.size() * sizeof(NFA::State), Counters::Resource());
+    NFA ret{
+        .arena = arena,
+        .start = 0,
+        .accept = {},
+        .states = std::pmr::vector<NFA::State>(arena.get()),
+        .numCases = nfa.numCases
+    };
+    ret.states.reserve(order.size());
+    for (size_t newI = 0; newI < order.size(); ++newI)
+    {
+        const size_t component = componentOf[order[newI]];
+        std::pmr::vector<NFA::Transition> transitions(ret.states.get_allocator());
+        transitions.reserve(edgesOf[component].size());
+        for (const auto& [lo, hi, result] : edgesOf[component])
+        {
+            transitions.push_back(NFA::Transition{ .lo = lo, .hi = hi, .to = newIndexOf[repOf[result]] });
+        }
+        std::ranges::sort(transitions, { }, [](const NFA::Transition& t) 
+        { 
+            return std::make_tuple(t.lo, t.hi, t.to); 
+        });
+        transitions.erase(std::unique(transitions.begin(), transitions.end(), 
+            [](const NFA::Transition& a, const NFA::Transition& b) 
+            { 
+                return a.lo == b.lo && a.hi == b.hi && a.to == b.to; 
+            }), transitions.end());
+
+        ret.states.emplace_back(newI, tagOf[component], std::move(transitions));
+        if (tagOf[component] != NO_CASE_TAG)
+        {
+            ret.accept.insert(newI);
+        }
+    }
+
+    Counters::Add(Counters::Counter_t::CLOSURES, numComponents);
+    Counters::Add(Counters::Counter_t::NFA_STATES, ret.states.size());
+    TRACE(INFO, "Removed epsilons: " << N << " nfa states -> " << ret.states.size() << std::endl);
+    return ret;
+}
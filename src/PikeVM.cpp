@@ -0,0 +1,116 @@
+/// @file PikeVM.cpp
+/// @brief Provides the definitions for the PikeVM class
+
+#include "PikeVM.hpp"
+
+#include "NFA.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+
+#include <algorithm>
+#include <utility>
+
+PikeVM::PikeVM(const NFA &nfa)
+    : PikeVM(CompactNFA(nfa))
+{ }
+
+PikeVM::PikeVM(const CompactNFA &nfa)
+    : PikeVM(CompactNFA(nfa))
+{ }
+
+PikeVM::PikeVM(CompactNFA &&nfa)
+    : nfa_(std::move(nfa)), stack_(), current_(), next_()
+{
+    const size_t N = nfa_.NumStates();
+
+    /// a state is pushed only when it enters a set, so the stack never holds
+    /// more than every state
+    ///
+    current_ = SparseSet{ .dense = std::vector<uint32_t>(N), .sparse = std::vector<uint32_t>(N), 
+        .size = 0 };
+    next_ = current_;
+    stack_.reserve(N);
+
+    TRACE(INFO, "PikeVM over " << N << " states" << std::endl);
+}
+
+Token PikeVM::MunchAt(std::string_view input, size_t offset)
+{
+    uint32_t tag = DFA::NO_TAG;
+    current_.size = 0;
+    AddClosure(current_, nfa_.start, tag);
+
+    /// the start state accepting is ignored, as a token can never be empty
+    ///
+    uint32_t matchTag = DFA::NO_TAG;
+    size_t matchLength = 0;
+    for (size_t i = offset; i < input.size() && current_.size != 0; ++i)
+    {
+        const uint8_t byte = static_cast<uint8_t>(input[i]);
+        tag = DFA::NO_TAG;
+        next_.size = 0;
+        for (size_t memberI = 0; memberI < current_.size; ++memberI)
+        {
+            const uint32_t state = current_.dense[memberI];
+            for (uint32_t t = nfa_.symbolBegin[state]; t < nfa_.symbolBegin[state + 1]; ++t)
+            {
+                if (nfa_.symbolLo[t] > byte) break; /// edges are sorted by range
+                if (nfa_.symbolHi[t] >= byte) AddClosure(next_, nfa_.symbolTargets[t], tag);
+            }
+        }
+        std::swap(current_, next_);
+
+        if (tag != DFA::NO_TAG)
+        {
+            matchTag = tag;
+            matchLength = i + 1 - offset;
+        }
+    }
+
+    /// no case matched, skip a single byte
+    ///
+    if (matchLength == 0)
+    {
+        return Token{ .caseTag = NO_CASE_TAG, .offset = offset, .length = 1 };
+    }
+    return Token{ .caseTag = matchTag, .offset = offset, .length = matchLength };
+}
+
+std::vector<Token> PikeVM::Tokenize(std::string_view input)
+{
+    std::vector<Token> tokens;
+    for (size_t offset = 0; offset < input.size(); offset += tokens.back().length)
+    {
+        tokens.push_back(MunchAt(input, offset));
+    }
+    return tokens;
+}
+
+size_t PikeVM::NumStates() const
+{
+    return nfa_.NumStates();
+}
+
+void PikeVM::AddClosure(SparseSet &set, uint32_t state, uint32_t &tag)
+{
+    /// a state in the set already brought its closure along
+    ///
+    if (set.Contains(state)) return;
+    set.Insert(state);
+    tag = std::min(tag, nfa_.tags[state]);
+    stack_.push_back(state);
+    while (!stack_.empty())
+    {
+        const uint32_t member = stack_.back();
+        stack_.pop_back();
+        for (uint32_t e = nfa_.epsilonBegin[member]; e < nfa_.epsilonBegin[member + 1]; ++e)
+        {
+            const uint32_t result = nfa_.epsilonTargets[e];
+            if (set.Contains(result)) continue;
+            set.Insert(result);
+            tag = std::min(tag, nfa_.tags[result]);
+            stack_.push_back(result);
+        }
+    }
+}
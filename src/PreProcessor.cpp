@@ -6,9 +6,9 @@
 #include <iostream>
 #include <stack>
 #include <unordered_map>
-#include <unordered_set>
+#include <optional>
 #include <sstream>
-#include <iomanip>
+#include <algorithm>
 #include <string_view>
 
 #include "RuleCase.hpp"
@@ -16,22 +16,6 @@
 #include "LexerUtil/Constants.hpp"
 #include "LexerUtil/Misc.hpp"
 
-#warning dbg in PreProcessor.cpp
-static void dbg(std::string_view patternData)
-{
-    DBG << std::hex << std::setfill('0');
-    for (char c : patternData)
-    {
-        DBG << "0x" << std::setw(2) << (int) c << ' ';
-    }
-    DBG << std::endl;
-}
-
-static void dbg(RuleCase& ruleCase)
-{
-    dbg(ruleCase.patternData);
-}
-
 void PreProcessor::PreProcess(RuleCase &ruleCase)
 {
     std::string& pattern = ruleCase.patternData;
@@ -54,14 +38,13 @@ void PreProcessor::PreProcess(RuleCase &ruleCase)
     }
     }
 
+    /// the steps of PreProcessRegex, traced
+    ///
     Encode(pattern);
-    DBG << "After Encode: " << RegexStr(pattern) << std::endl;
-
-    UnifyRanges(pattern);
-    DBG << "After unify: " << RegexStr(pattern) << std::endl;
+    TRACE(DEBUG, "After Encode: " << RegexStr(pattern) << std::endl);
 
     InsertConcats(pattern);
-    DBG << "After insert: " << RegexStr(pattern) << std::endl;
+    TRACE(DEBUG, "After insert: " << RegexStr(pattern) << std::endl);
 }
 
 void PreProcessor::PreProcess(std::vector<RuleCase> &patterns)
@@ -72,254 +55,13 @@ void PreProcessor::PreProcess(std::vector<RuleCase> &patterns)
     }
 }
 
-bool PreProcessor::IsOperator(char c)
-{
-    char decoded = Decode(c);
-    return (decoded != c);
-}
-
-auto PreProcessor::OperatorOf(char c) -> Operator_t
-{
-    ENSURES_THROW(IsOperator(c), std::format("Invalid operator '{}' requested", c));
-    
-    switch((OpEncoded) c)
-    {
-        case OpEncoded::UNION: return Operator_t::UNION;
-        case OpEncoded::CONCAT: return Operator_t::CONCAT;
-        case OpEncoded::KLEENE: return Operator_t::KSTAR;
-        case OpEncoded::PLUS: return Operator_t::KPLUS;
-        case OpEncoded::OPTIONAL: return Operator_t::OPTIONAL;
-        case OpEncoded::LPAREN: return Operator_t::LPAREN;
-        case OpEncoded::RPAREN: return Operator_t::RPAREN;
-        default: break;
-    }
-    
-    throw( std::logic_error("unreachable") );
-}
-
-uint32_t PreProcessor::PriorityOf(Operator_t op)
+void PreProcessor::Invalid(std::string_view message, std::string_view pattern)
 {
-    switch( op )
-    {
-    case Operator_t::UNION: return 0;
-    case Operator_t::CONCAT: return 1;
-    
-    case Operator_t::KSTAR:
-    case Operator_t::KPLUS: 
-    case Operator_t::OPTIONAL: 
-    {
-        return 2;
-    }
-    case Operator_t::LPAREN: return 3;
-    case Operator_t::RPAREN: return 4;
-    default: return -1;
-    }
-}
-
-bool PreProcessor::isBinary(Operator_t op)
-{
-    switch( op )
-    {
-    case Operator_t::KSTAR:
-    case Operator_t::KPLUS:
-    case Operator_t::OPTIONAL:
-    {
-        return true;
-    }    
-    default: 
-    {
-        return false;
-    }
-    }
-}
-
-template <typename Operator_t>
-auto PreProcessor::GetType(char c) -> SymbolClass
-{  
-    switch(( (Operator_t) c))
-    {
-    case Operator_t::UNION:
-    case Operator_t::CONCAT:
-        return SymbolClass::BINARY_OP;
-
-    case Operator_t::KLEENE:
-    case Operator_t::PLUS:
-    case Operator_t::OPTIONAL:
-        return SymbolClass::UNARY_OP;
-
-    case Operator_t::LPAREN: return SymbolClass::LPAREN;
-    case Operator_t::RPAREN: return SymbolClass::RPAREN;
-    
-    case Operator_t::LBRACE:
-    case Operator_t::RBRACE:
-    case Operator_t::INVERT:
-    case Operator_t::RANGE_MID:
-        return SymbolClass::RANGE_OP;
-    
-    default: return SymbolClass::LITERAL; // if not an operator, then it's a literal
-    }
-}
-
-template PreProcessor::SymbolClass PreProcessor::GetType<PreProcessor::OpDecoded>(char c);
-template PreProcessor::SymbolClass PreProcessor::GetType<PreProcessor::OpEncoded>(char c);
-
-auto PreProcessor::EncodeOp(OpDecoded op) -> OpEncoded
-{
-    switch(op) 
-    {
-    case OpDecoded::UNION:     return OpEncoded::UNION;
-    case OpDecoded::CONCAT:    return OpEncoded::CONCAT;
-    case OpDecoded::KLEENE:    return OpEncoded::KLEENE;
-    case OpDecoded::PLUS:      return OpEncoded::PLUS;
-    case OpDecoded::OPTIONAL:  return OpEncoded::OPTIONAL;
-    case OpDecoded::LPAREN:    return OpEncoded::LPAREN;
-    case OpDecoded::RPAREN:    return OpEncoded::RPAREN;
-    case OpDecoded::LBRACE:    return OpEncoded::LBRACE;
-    case OpDecoded::RBRACE:    return OpEncoded::RBRACE;
-    case OpDecoded::INVERT:    return OpEncoded::INVERT;
-    case OpDecoded::RANGE_MID: return OpEncoded::RANGE_MID;
-    default: THROW_ERR("TODO: UNKERR?");
-    }
+    if (pattern.empty()) THROW_ERR(message);
+    THROW_ERR(std::format("{} in regex \"{}\"", message, pattern));
     UNREACHABLE();
 }
 
-char PreProcessor::Decode(char c)
-{
-    switch( (OpEncoded) c )
-    {
-        case OpEncoded::UNION:     return (char)OpDecoded::UNION;
-        case OpEncoded::CONCAT:    return (char)OpDecoded::CONCAT;
-        case OpEncoded::KLEENE:    return (char)OpDecoded::KLEENE;
-        case OpEncoded::PLUS:      return (char)OpDecoded::PLUS;
-        case OpEncoded::OPTIONAL:  return (char)OpDecoded::OPTIONAL;
-        case OpEncoded::LPAREN:    return (char)OpDecoded::LPAREN;
-        case OpEncoded::RPAREN:    return (char)OpDecoded::RPAREN;
-        case OpEncoded::LBRACE:    return (char)OpDecoded::LBRACE;
-        case OpEncoded::RBRACE:    return (char)OpDecoded::RBRACE;
-        case OpEncoded::INVERT:    return (char)OpDecoded::INVERT;
-        case OpEncoded::RANGE_MID: return (char)OpDecoded::RANGE_MID;
-        default: return c;
-    }
-}
-
-void PreProcessor::Encode(std::string &pattern)
-{
-    std::string ret;
-    ret.reserve(pattern.size());
-
-    for (size_t i=0;i<pattern.size();++i) 
-    {
-        if (pattern[i] == '\\') 
-        {
-            i += 1; // advance to skip the next char (which is escaped)
-            ENSURES_THROW(i < pattern.size(), "Unmatched '\'."); // unmatched '\'
-            ret.push_back(pattern[i]); // add the escaped char as a literal
-        }
-        else if (GetType<OpDecoded>(pattern[i]) != SymbolClass::LITERAL) 
-        {
-            ret.push_back((char) EncodeOp((OpDecoded) pattern[i]));
-        }
-        else 
-        {
-            ret.push_back(pattern[i]);
-        }
-    }
-
-    pattern = std::move(ret);   
-}
-
-void PreProcessor::UnifyRanges(std::string &pattern)
-{
-    std::stringstream ss; // output string stream to set the pattern to
-    size_t startI = 0; // starting index of the current range
-    size_t endI = 0; // ending index of the current range
-
-    while(1)
-    {
-        /// find the first occurence of an encoded left range op in the string
-        ///
-        startI = pattern.find((char)OpEncoded::LBRACE, endI);
-
-        /// include all the characters outside of the string in the output string
-        ///
-        for (size_t i = endI; i < (startI == std::string::npos ? pattern.size() : startI);++i) 
-        {
-            ss << pattern[i];
-        }
-
-        /// handle right range operator found without left range op e.g. "123]"
-        /// 
-        endI = pattern.find((char)OpEncoded::RBRACE, (startI == std::string::npos ? endI : startI));
-        ENSURES_THROW( !(startI == std::string::npos && endI != std::string::npos), 
-            std::format("Unmatched {} in regex \"{}\"", (char)OpDecoded::RBRACE, RegexStr(pattern)));
-
-        if (startI == std::string::npos) break; /// there is no more range 
-        ENSURES_THROW(endI != std::string::npos, 
-            std::format("Unmatched {}, in regex \"{}\"", (char)OpDecoded::LBRACE, RegexStr(pattern)));
-
-        /// determine if the range is inverted, and actually form the range
-        ///
-        bool invertedRange = (pattern[startI+1] == (char)OpEncoded::INVERT); 
-        startI = (invertedRange ? startI+2 : startI+1);
-        std::string_view range = std::string_view{pattern}.substr(startI, endI - startI);    
-        ENSURES_THROW(range.size() > 0, std::format("Empty {}{} in regex \"{}\"", 
-            (char)OpDecoded::LBRACE, (char)OpDecoded::RBRACE, RegexStr(pattern)));
-        
-        /// finally, actually calculate this specific range instance
-        ///
-        std::unordered_set<char> rangeSet = { };
-        std::unordered_set<char> invRangeSet = ALPHABET;
-        for (size_t rangeI = 0; rangeI < range.size(); ++rangeI)
-        {
-            if (rangeI + 2 < range.size() && range[rangeI+1] == (char) OpEncoded::RANGE_MID)
-            {
-                for (char c = Decode(range[rangeI]); c <= Decode(range[rangeI+2]);++c)
-                {
-                    rangeSet.insert(c);
-                    invRangeSet.erase(c);
-                }
-                rangeI += 2;
-            }
-            else 
-            {
-                char decodedC = Decode(range[rangeI]);
-                rangeSet.insert(decodedC);
-                invRangeSet.erase(decodedC);
-            }
-        }
-        ss << (char)OpEncoded::LPAREN;
-        std::string_view delim = "";
-        for (char c : (invertedRange ? invRangeSet : rangeSet))
-        {
-            ss << delim << c;
-            delim = std::string(1, (char)OpEncoded::UNION);
-        }
-        ss << (char)OpEncoded::RPAREN;
-        
-        ++endI; // advance the end so we don't see the same rbrace
-    }
-    pattern = std::move(ss.str());
-}
-
-void PreProcessor::InsertConcats(std::string &pattern)
-{
-    std::stringstream ss;
-
-    ss << pattern[0];
-    for (size_t i = 1; i < pattern.size();++i)
-    {
-        SymbolClass left = GetType<OpEncoded>(pattern[i-1]);
-        SymbolClass right = GetType<OpEncoded>(pattern[i]);
-        if ( (left == SymbolClass::LITERAL || left == SymbolClass::UNARY_OP || left == SymbolClass::RPAREN) &&
-             (right == SymbolClass::LITERAL || right == SymbolClass::LPAREN) )
-        {
-            ss << (char)OpEncoded::CONCAT;
-        }
-        ss << pattern[i];
-    }
-    pattern = std::move(ss.str());
-}
-
 void PreProcessor::makeRPN(std::string &pattern)
 {
     /// define the operator precedence map
@@ -411,9 +153,22 @@ void PreProcessor::makeRPN(std::string &pattern)
 
 void PreProcessor::PrintRegex(std::ostream &os, std::string_view pattern)
 {
-    for (char c : pattern)
+    for (size_t i = 0; i < pattern.size(); ++i)
     {
-        os << Decode(c);
+        if (!IsClass(pattern[i]))
+        {
+            os << Decode(pattern[i]);
+            continue;
+        }
+
+        os << (char)OpDecoded::LBRACE;
+        ClassAt(pattern, i).ForEachRange([&os](uint8_t lo, uint8_t hi)
+        {
+            os << Escaped(lo);
+            if (lo != hi) os << (char)OpDecoded::RANGE_MID << Escaped(hi);
+        });
+        os << (char)OpDecoded::RBRACE;
+        i += CLASS_SIZE - 1;
     }
 }
 
@@ -0,0 +1,469 @@
+/// @file Prefilter.cpp
+/// @brief Provides the definitions for the Prefilter class
+
+#include "Prefilter.hpp"
+
+#include "PreProcessor.hpp"
+#include "RuleCase.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+#include "LexerUtil/Misc.hpp"
+#include "LexerUtil/Simd.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stack>
+
+/// @brief what is known of the literals of a sub-expression. The exact set is the
+///        whole (finite, small) language of the sub-expression, which concatenation
+///        can extend; the factor is the best required factor found so far
+struct Prefilter::Info
+{
+    size_t maxLength; ///< length of the longest match, or UNBOUNDED
+    std::optional<std::vector<std::string>> exact; ///< every string matched, if few
+    std::optional<Factor> factor; ///< the best required factor, if any
+};
+
+/// @brief sort and deduplicate a set of literals
+static void Normalize(std::vector<std::string>& literals)
+{
+    std::ranges::sort(literals);
+    literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+}
+
+std::optional<Prefilter::Factor> Prefilter::RequiredFactor(const RuleCase &ruleCase)
+{
+    if (ruleCase.patternType == RuleCase::Pattern_t::STRING)
+    {
+        if (ruleCase.patternData.empty()) return std::nullopt;
+        return Literal(ruleCase.patternData).factor;
+    }
+    if (ruleCase.patternType != RuleCase::Pattern_t::REGEX) return std::nullopt;
+
+    RuleCase preProcessed = ruleCase;
+    PreProcessor::PreProcess(preProcessed);
+
+    /// the same shunting yard as NFABuilder::ShuntingYard, evaluating the
+    /// literal info of each operand instead of its nfa fragment
+    ///
+    bool expectOperand = true;
+    std::stack<PreProcessor::Operator_t> opStack;
+    std::stack<Info> infoStack;
+
+    auto Apply = [&infoStack](PreProcessor::Operator_t op) -> Info
+    {
+        using enum PreProcessor::Operator_t;
+        switch ( op )
+        {
+        case UNION:
+        {
+            Info right = pop(infoStack);
+            Info left = pop(infoStack);
+            return Union(left, right);
+        }
+        case CONCAT:
+        {
+            Info right = pop(infoStack);
+            Info left = pop(infoStack);
+            return Concat(left, right);
+        }
+        case KSTAR: return Star(pop(infoStack));
+        case KPLUS: return Plus(pop(infoStack));
+        case OPTIONAL: return Optional(pop(infoStack));
+        default: THROW_ERR("Unhandled case in Prefilter::RequiredFactor()");
+        }
+        UNREACHABLE();
+    };
+
+    std::string_view pattern = preProcessed.patternData;
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        char c = pattern[i];
+        if (PreProcessor::IsClass(c))
+        {
+            EXPECTS_THROW(expectOperand, "Expected literal, got a class");
+            infoStack.push(Class(PreProcessor::ClassAt(pattern, i)));
+            i += PreProcessor::CLASS_SIZE - 1;
+            expectOperand = false;
+            continue;
+        }
+        if (!PreProcessor::IsOperator(c))
+        {
+            EXPECTS_THROW(expectOperand, std::format("Expected literal, got '{}'", c));
+            infoStack.push(Char(c));
+            expectOperand = false;
+            continue;
+        }
+
+        PreProcessor::Operator_t op = PreProcessor::OperatorOf(c);
+        if (op == PreProcessor::Operator_t::LPAREN)
+        {
+            opStack.push(op);
+            expectOperand = true;
+        }
+        else if (op == PreProcessor::Operator_t::RPAREN)
+        {
+            EXPECTS_THROW(!expectOperand, "Unexpected ')'");
+            while (!opStack.empty() && opStack.top() != PreProcessor::Operator_t::LPAREN)
+            {
+                infoStack.push(Apply(pop(opStack)));
+            }
+            ENSURES_THROW(!opStack.empty(), "Unmatched ')'");
+            opStack.pop();
+            expectOperand = false;
+        }
+        else
+        {
+            EXPECTS_THROW(!expectOperand, "Unexpected operator");
+            while (!opStack.empty() && opStack.top() != PreProcessor::Operator_t::LPAREN &&
+                    (PreProcessor::PriorityOf(opStack.top()) > PreProcessor::PriorityOf(op) ||
+                     (PreProcessor::PriorityOf(opStack.top()) == PreProcessor::PriorityOf(op)
+                        && PreProcessor::isBinary(op)) ) )
+            {
+                infoStack.push(Apply(pop(opStack)));
+            }
+            opStack.push(op);
+            expectOperand = !PreProcessor::isBinary(op);
+        }
+    }
+    while (!opStack.empty())
+    {
+        PreProcessor::Operator_t op = pop(opStack);
+        ENSURES_THROW(op != PreProcessor::Operator_t::LPAREN, "Unmatched '('");
+        infoStack.push(Apply(op));
+    }
+    ENSURES_THROW(infoStack.size() == 1, "Malformed regex");
+
+    return infoStack.top().factor;
+}
+
+std::optional<Prefilter::Factor> Prefilter::RequiredFactor(const Regex::Flat::Type &expr)
+{
+    using namespace Regex::Flat;
+
+    std::stack<Info> infoStack;
+    for (const Symbol& sym : expr)
+    {
+        infoStack.push(
+            std::visit([&](auto&& symU) -> Info
+            {
+                using T = std::decay_t<decltype(symU)>;
+
+                if constexpr (std::is_same_v<T, Char_t>)
+                {
+                    return Char(symU.value);
+                }
+                else if constexpr (std::is_same_v<T, Charset_t>)
+                {
+                    return Charset(symU.lo, symU.hi, symU.inverted);
+                }
+                else if constexpr (std::is_same_v<T, Literal_t>)
+                {
+                    return Literal(symU.value);
+                }
+                else if constexpr (std::is_same_v<T, Union_t>)
+                {
+                    Info right = pop(infoStack);
+                    Info left = pop(infoStack);
+                    return Union(left, right);
+                }
+                else if constexpr (std::is_same_v<T, Concat_t>)
+                {
+                    Info right = pop(infoStack);
+                    Info left = pop(infoStack);
+                    return Concat(left, right);
+                }
+                else if constexpr (std::is_same_v<T, KleeneStar_t>)
+                {
+                    return Star(pop(infoStack));
+                }
+            }, sym)
+        );
+    }
+    ENSURES_THROW(infoStack.size() == 1, "Unexpected additional operands in postorder evaluation");
+    return infoStack.top().factor;
+}
+
+std::optional<Prefilter> Prefilter::Build(const std::vector<RuleCase> &ruleCases)
+{
+    std::vector<Factor> factors;
+    for (const RuleCase& ruleCase : ruleCases)
+    {
+        if (ruleCase.patternType == RuleCase::Pattern_t::NONE ||
+            ruleCase.patternType == RuleCase::Pattern_t::END_OF_FILE)
+        {
+            continue;
+        }
+
+        std::optional<Factor> factor = RequiredFactor(ruleCase);
+        if (!factor) return std::nullopt;
+        factors.push_back(std::move(*factor));
+    }
+    if (factors.empty()) return std::nullopt;
+    return Prefilter(factors);
+}
+
+Prefilter::Prefilter(const std::vector<Factor> &factors)
+    : literals_(), maxOffset_(0), byFirstByte_{}, isFirstByte_{}, lo_{}, hi_{}, numRanges_(0)
+{
+    for (const Factor& factor : factors)
+    {
+        literals_.insert(literals_.end(), factor.literals.begin(), factor.literals.end());
+        maxOffset_ = std::max(maxOffset_, factor.maxOffset);
+    }
+    Normalize(literals_);
+
+    for (size_t i = 0; i < literals_.size(); ++i)
+    {
+        EXPECTS_THROW(!literals_[i].empty(), "Empty prefilter literal");
+        const uint8_t first = static_cast<uint8_t>(literals_[i][0]);
+        byFirstByte_[first].push_back(static_cast<uint32_t>(i));
+        isFirstByte_[first] = true;
+    }
+
+    /// the first bytes are searched for with the vectorized range kernel when
+    /// they form a few ranges
+    ///
+    bool fits = true;
+    for (size_t byte = 0; byte < 256 && fits; ++byte)
+    {
+        if (!isFirstByte_[byte]) continue;
+        if (numRanges_ > 0 && hi_[numRanges_ - 1] + 1u == byte)
+        {
+            hi_[numRanges_ - 1] = static_cast<uint8_t>(byte);
+        }
+        else if (numRanges_ < lo_.size())
+        {
+            lo_[numRanges_] = hi_[numRanges_] = static_cast<uint8_t>(byte);
+            ++numRanges_;
+        }
+        else
+        {
+            fits = false;
+        }
+    }
+    if (!fits) numRanges_ = 0;
+
+    TRACE(INFO, "Prefilter over " << literals_.size() << " literals, max offset "
+        << (maxOffset_ == UNBOUNDED ? std::string("unbounded") : std::to_string(maxOffset_))
+        << std::endl);
+}
+
+size_t Prefilter::Find(std::string_view text, size_t from) const
+{
+    const uint8_t* const begin = reinterpret_cast<const uint8_t*>(text.data());
+    const uint8_t* const end = begin + text.size();
+    const uint8_t* p = begin + std::min(from, text.size());
+
+    while (true)
+    {
+        if (numRanges_ != 0)
+        {
+            p = FindInRanges(p, end, lo_.data(), hi_.data(), numRanges_);
+        }
+        else
+        {
+            while (p != end && !isFirstByte_[*p]) ++p;
+        }
+        if (p == end) return std::string_view::npos;
+
+        for (uint32_t literalI : byFirstByte_[*p])
+        {
+            const std::string& literal = literals_[literalI];
+            if (static_cast<size_t>(end - p) >= literal.size() &&
+                std::memcmp(p, literal.data(), literal.size()) == 0)
+            {
+                return static_cast<size_t>(p - begin);
+            }
+        }
+        ++p;
+    }
+}
+
+size_t Prefilter::MaxOffset() const
+{
+    return maxOffset_;
+}
+
+const std::vector<std::string> &Prefilter::Literals() const
+{
+    return literals_;
+}
+
+/// -----------------------------------------------------------------------------------------------
+/// Literal analysis
+/// -----------------------------------------------------------------------------------------------
+
+auto Prefilter::Char(char c) -> Info
+{
+    return Literal(std::string_view{&c, 1});
+}
+
+auto Prefilter::Charset(char lo, char hi, bool inverted) -> Info
+{
+    CharClass range = CharClass::Range(static_cast<uint8_t>(lo), static_cast<uint8_t>(hi));
+    return Class(inverted ? range.NegatedIn(ALPHABET_CLASS) : range);
+}
+
+auto Prefilter::Class(const CharClass& charClass) -> Info
+{
+    /// a wide class (such as an inverted one) is not worth a factor
+    ///
+    if (charClass.Empty() || charClass.Size() > MAX_LITERALS)
+    {
+        return Info{ .maxLength = 1, .exact = std::nullopt, .factor = std::nullopt };
+    }
+
+    std::vector<std::string> chars;
+    charClass.ForEachRange([&chars](uint8_t lo, uint8_t hi)
+    {
+        for (size_t c = lo; c <= hi; ++c)
+        {
+            chars.emplace_back(1, static_cast<char>(c));
+        }
+    });
+    return Exact(std::move(chars));
+}
+
+auto Prefilter::Literal(std::string_view string) -> Info
+{
+    /// a long literal is still a required factor, just not one that can be
+    /// extended, so only its first MAX_LITERAL_LENGTH bytes are kept
+    ///
+    if (string.size() > MAX_LITERAL_LENGTH)
+    {
+        return Info{
+            .maxLength = string.size(),
+            .exact = std::nullopt,
+            .factor = Factor{ .literals = { std::string(string.substr(0, MAX_LITERAL_LENGTH)) },
+                .maxOffset = 0 }
+        };
+    }
+    return Exact({ std::string(string) });
+}
+
+auto Prefilter::Exact(std::vector<std::string> strings) -> Info
+{
+    Normalize(strings);
+    const size_t maxLength = std::ranges::max(strings, { }, &std::string::size).size();
+    return Info{
+        .maxLength = maxLength,
+        .exact = strings,
+        .factor = Factor{ .literals = strings, .maxOffset = 0 }
+    };
+}
+
+auto Prefilter::Concat(const Info &left, const Info &right) -> Info
+{
+    Info ret{
+        .maxLength = (left.maxLength == UNBOUNDED || right.maxLength == UNBOUNDED ?
+            UNBOUNDED : left.maxLength + right.maxLength),
+        .exact = std::nullopt,
+        .factor = left.factor
+    };
+
+    /// a factor of the right side moves by at most the longest left match
+    ///
+    if (right.factor)
+    {
+        Factor shifted = *right.factor;
+        shifted.maxOffset = (left.maxLength == UNBOUNDED || shifted.maxOffset == UNBOUNDED ?
+            UNBOUNDED : shifted.maxOffset + left.maxLength);
+        if (!ret.factor || Better(shifted, *ret.factor)) ret.factor = std::move(shifted);
+    }
+
+    /// two exact sets concatenate into one, as long as it stays small
+    ///
+    if (left.exact && right.exact &&
+        left.exact->size() * right.exact->size() <= MAX_LITERALS)
+    {
+        std::vector<std::string> product;
+        bool fits = true;
+        for (const std::string& l : *left.exact)
+        {
+            for (const std::string& r : *right.exact)
+            {
+                fits &= (l.size() + r.size() <= MAX_LITERAL_LENGTH);
+                product.push_back(l + r);
+            }
+        }
+        if (fits)
+        {
+            Info exact = Exact(std::move(product));
+            ret.exact = std::move(exact.exact);
+            if (!ret.factor || Better(*exact.factor, *ret.factor)) ret.factor = std::move(exact.factor);
+        }
+    }
+    return ret;
+}
+
+auto Prefilter::Union(const Info &left, const Info &right) -> Info
+{
+    Info ret{
+        .maxLength = std::max(left.maxLength, right.maxLength),
+        .exact = std::nullopt,
+        .factor = std::nullopt
+    };
+
+    if (left.exact && right.exact && left.exact->size() + right.exact->size() <= MAX_LITERALS)
+    {
+        std::vector<std::string> both = *left.exact;
+        both.insert(both.end(), right.exact->begin(), right.exact->end());
+        Info exact = Exact(std::move(both));
+        ret.exact = std::move(exact.exact);
+        ret.factor = std::move(exact.factor);
+    }
+
+    /// either side may match, so a factor needs the literals of both sides
+    ///
+    if (left.factor && right.factor &&
+        left.factor->literals.size() + right.factor->literals.size() <= MAX_LITERALS)
+    {
+        Factor both{
+            .literals = left.factor->literals,
+            .maxOffset = std::max(left.factor->maxOffset, right.factor->maxOffset)
+        };
+        both.literals.insert(both.literals.end(), right.factor->literals.begin(),
+            right.factor->literals.end());
+        Normalize(both.literals);
+        if (!ret.factor || Better(both, *ret.factor)) ret.factor = std::move(both);
+    }
+    return ret;
+}
+
+auto Prefilter::Star(const Info &info) -> Info
+{
+    (void)info;
+    return Info{ .maxLength = UNBOUNDED, .exact = std::nullopt, .factor = std::nullopt };
+}
+
+auto Prefilter::Plus(const Info &info) -> Info
+{
+    /// the first iteration holds the factor where it would be alone
+    ///
+    return Info{ .maxLength = UNBOUNDED, .exact = std::nullopt, .factor = info.factor };
+}
+
+auto Prefilter::Optional(const Info &info) -> Info
+{
+    return Info{ .maxLength = info.maxLength, .exact = std::nullopt, .factor = std::nullopt };
+}
+
+bool Prefilter::Better(const Factor &a, const Factor &b)
+{
+    /// a bounded offset limits how far back a literal hit is verified from,
+    /// then longer literals are rarer, and fewer literals are cheaper to verify
+    ///
+    auto ShortestOf = [](const Factor& factor)
+    {
+        return std::ranges::min(factor.literals, { }, &std::string::size).size();
+    };
+    auto Key = [&](const Factor& factor)
+    {
+        return std::make_tuple(factor.maxOffset != UNBOUNDED, std::min<size_t>(ShortestOf(factor), 8),
+            -static_cast<ptrdiff_t>(factor.literals.size()), -static_cast<ptrdiff_t>(
+                factor.maxOffset == UNBOUNDED ? 0 : factor.maxOffset));
+    };
+    return Key(a) > Key(b);
+}
@@ -0,0 +1,278 @@
+/// @file Scanner.cpp
+/// @brief Provides the definitions for the Scanner class
+
+#include "Scanner.hpp"
+
+#include "LexerUtil/Constants.hpp"
+#include "LexerUtil/Macros.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+Scanner::Scanner(const DFA &dfa, std::string_view input)
+    : Scanner(dfa.View(), input)
+{ }
+
+Scanner::Scanner(const DFA::Tables &tables, std::string_view input)
+    : tables_(tables), input_(input), offset_(0)
+{ }
+
+bool Scanner::Next(Token &token)
+{
+    if (offset_ == input_.size()) return false;
+
+    token = MunchAt(tables_, input_, offset_);
+    offset_ += token.length;
+    return true;
+}
+
+Token Scanner::MunchAt(const DFA::Tables &tables, std::string_view input, size_t offset)
+{
+    /// find the longest match from the offset. Running out of input ends
+    /// the munch the same way the dfa dying does
+    ///
+    Munch munch = Begin(tables);
+    Advance(tables, munch, input.data() + offset, input.data() + input.size());
+
+    /// no case matched, skip a single byte
+    ///
+    if (munch.length == 0)
+    {
+        munch.length = 1;
+        munch.tag = DFA::NO_TAG;
+    }
+
+    return Token{
+        .caseTag = (munch.tag == DFA::NO_TAG ? NO_CASE_TAG : munch.tag),
+        .offset = offset,
+        .length = munch.length
+    };
+}
+
+std::string_view Scanner::Lexeme(const Token &token) const
+{
+    EXPECTS_THROW(token.offset + token.length <= input_.size(),
+        "Token does not belong to the scanned input");
+    return input_.substr(token.offset, token.length);
+}
+
+size_t Scanner::Offset() const
+{
+    return offset_;
+}
+
+std::vector<Token> Scanner::ScanParallel(const DFA::Tables &tables, std::string_view input,
+    size_t numThreads)
+{
+    /// chunks smaller than this cost more to hand out than to scan
+    ///
+    constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+    if (numThreads == 0)
+    {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    const size_t numChunks = std::max<size_t>(1, 
+        std::min(numThreads, input.size() / MIN_CHUNK_SIZE));
+    const size_t chunkSize = (input.size() + numChunks - 1) / std::max<size_t>(1, numChunks);
+    auto ChunkBegin = [&](size_t chunk)
+    {
+        return std::min(input.size(), chunk * chunkSize);
+    };
+
+    /// each chunk is scanned as if a token started at its first byte, up to the
+    /// first token starting in the next chunk. Tokens may read past the end of
+    /// their chunk, as the whole input is available
+    ///
+    std::vector<std::vector<Token>> speculative(numChunks);
+    auto ScanChunk = [&](size_t chunk)
+    {
+        std::vector<Token>& tokens = speculative[chunk];
+        const size_t last = ChunkBegin(chunk + 1);
+        for (size_t offset = ChunkBegin(chunk); offset < last; )
+        {
+            tokens.push_back(MunchAt(tables, input, offset));
+            offset += tokens.back().length;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numChunks - 1);
+    for (size_t chunk = 1; chunk < numChunks; ++chunk)
+    {
+        threads.emplace_back(ScanChunk, chunk);
+    }
+    ScanChunk(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    /// the token starting at an offset does not depend on how the offset was
+    /// reached, so once the true stream hits a token start of a speculative
+    /// scan, the rest of that scan is correct. Until then the true stream is
+    /// rescanned. The first chunk is always correct, as the input starts a token
+    ///
+    std::vector<Token> tokens;
+    tokens.reserve(std::accumulate(speculative.begin(), speculative.end(), size_t(0),
+        [](size_t sum, const std::vector<Token>& chunk) { return sum + chunk.size(); }));
+    size_t offset = 0;
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const std::vector<Token>& guess = speculative[chunk];
+        const size_t last = ChunkBegin(chunk + 1);
+        auto it = guess.begin();
+        while (offset < last)
+        {
+            while (it != guess.end() && it->offset < offset) ++it;
+            if (it != guess.end() && it->offset == offset)
+            {
+                tokens.insert(tokens.end(), it, guess.end());
+                offset = guess.back().offset + guess.back().length;
+                break;
+            }
+            tokens.push_back(MunchAt(tables, input, offset));
+            offset += tokens.back().length;
+        }
+    }
+    return tokens;
+}
+
+StreamScanner::StreamScanner(const DFA &dfa)
+    : StreamScanner(dfa.View())
+{ }
+
+StreamScanner::StreamScanner(const DFA::Tables &tables)
+    : tables_(tables), munch_(Scanner::Begin(tables)), window_(), chunk_(), chunkOffset_(0), 
+      offset_(0), dropLength_(0), finished_(false)
+{ }
+
+void StreamScanner::Feed(std::string_view chunk)
+{
+    EXPECTS_THROW(!finished_, "Chunk fed to a finished stream");
+    EXPECTS_THROW(chunkOffset_ == chunk_.size() && dropLength_ == 0,
+        "Chunk fed before the previous chunk was fully scanned");
+
+    chunk_ = chunk;
+    chunkOffset_ = 0;
+}
+
+void StreamScanner::Finish()
+{
+    finished_ = true;
+}
+
+bool StreamScanner::Next(Token &token, std::string_view &lexeme)
+{
+    Drop();
+
+    /// the remaining input is the window followed by the rest of the chunk,
+    /// and the token in flight starts at the front of it
+    ///
+    const size_t available = window_.size() + (chunk_.size() - chunkOffset_);
+    if (available == 0) return false;
+
+    /// resume the munch where it stopped, first over the window then the chunk
+    ///
+    bool died = false;
+    if (munch_.consumed < window_.size())
+    {
+        died = Scanner::Advance(tables_, munch_, window_.data() + munch_.consumed, 
+            window_.data() + window_.size());
+    }
+    if (!died)
+    {
+        const char* resume = chunk_.data() + chunkOffset_ + (munch_.consumed - window_.size());
+        died = Scanner::Advance(tables_, munch_, resume, chunk_.data() + chunk_.size());
+    }
+
+    /// the token may continue into the next chunk, so keep the bytes in flight
+    ///
+    if (!died && !finished_)
+    {
+        window_.append(chunk_.substr(chunkOffset_));
+        chunkOffset_ = chunk_.size();
+        return false;
+    }
+
+    /// no case matched, skip a single byte
+    ///
+    if (munch_.length == 0)
+    {
+        munch_.length = 1;
+        munch_.tag = DFA::NO_TAG;
+    }
+    const size_t length = munch_.length;
+
+    /// a token spanning the window and the chunk is made contiguous in the window
+    ///
+    if (window_.empty())
+    {
+        lexeme = chunk_.substr(chunkOffset_, length);
+    }
+    else
+    {
+        if (length > window_.size())
+        {
+            size_t fromChunk = length - window_.size();
+            window_.append(chunk_.substr(chunkOffset_, fromChunk));
+            chunkOffset_ += fromChunk;
+        }
+        lexeme = std::string_view{window_}.substr(0, length);
+    }
+
+    token = Token{
+        .caseTag = (munch_.tag == DFA::NO_TAG ? NO_CASE_TAG : munch_.tag),
+        .offset = offset_,
+        .length = length
+    };
+    offset_ += length;
+    dropLength_ = length;
+    munch_ = Scanner::Begin(tables_);
+    return true;
+}
+
+size_t StreamScanner::Offset() const
+{
+    return offset_;
+}
+
+void StreamScanner::Drop()
+{
+    /// bytes past the end of the token are scanned again as the next token
+    ///
+    if (dropLength_ <= window_.size())
+    {
+        window_.erase(0, dropLength_);
+    }
+    else
+    {
+        chunkOffset_ += dropLength_ - window_.size();
+        window_.clear();
+    }
+    dropLength_ = 0;
+}
+
+FileScanner::FileScanner(const DFA &dfa, const char *path)
+    : FileScanner(dfa.View(), path)
+{ }
+
+FileScanner::FileScanner(const DFA::Tables &tables, const char *path)
+    : file_(path), scanner_(tables, file_.View())
+{ }
+
+bool FileScanner::Next(Token &token)
+{
+    return scanner_.Next(token);
+}
+
+std::string_view FileScanner::Lexeme(const Token &token) const
+{
+    return scanner_.Lexeme(token);
+}
+
+std::string_view FileScanner::Input() const
+{
+    return file_.View();
+}
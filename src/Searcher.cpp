@@ -0,0 +1,71 @@
+/// @file Searcher.cpp
+/// @brief Provides the definitions for the Searcher class
+
+#include "Searcher.hpp"
+
+#include "NFABuilder.hpp"
+#include "RuleCase.hpp"
+
+Searcher::Searcher(const std::vector<RuleCase> &ruleCases)
+    : dfa_(BuildDFA(ruleCases)), prefilter_(Prefilter::Build(ruleCases))
+{ }
+
+bool Searcher::Find(std::string_view text, size_t from, Token &match) const
+{
+    const DFA::Tables tables = dfa_.View();
+    size_t literal = 0; /// offset of the next literal occurrence at or after pos
+    bool haveLiteral = false;
+
+    for (size_t pos = from; pos < text.size(); ++pos)
+    {
+        /// no match starts more than MaxOffset() bytes before the next literal
+        /// occurrence, and none starts past the last one
+        ///
+        if (prefilter_)
+        {
+            if (!haveLiteral || literal < pos)
+            {
+                literal = prefilter_->Find(text, pos);
+                if (literal == std::string_view::npos) return false;
+                haveLiteral = true;
+            }
+            const size_t maxOffset = prefilter_->MaxOffset();
+            if (maxOffset != Prefilter::UNBOUNDED && literal - pos > maxOffset)
+            {
+                pos = literal - maxOffset;
+            }
+        }
+
+        Scanner::Munch munch = Scanner::Begin(tables);
+        Scanner::Advance(tables, munch, text.data() + pos, text.data() + text.size());
+        if (munch.length != 0)
+        {
+            match = Token{ .caseTag = munch.tag, .offset = pos, .length = munch.length };
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Token> Searcher::FindAll(std::string_view text) const
+{
+    std::vector<Token> matches;
+    Token match{ };
+    for (size_t from = 0; Find(text, from, match); from = match.offset + match.length)
+    {
+        matches.push_back(match);
+    }
+    return matches;
+}
+
+const std::optional<Prefilter> &Searcher::GetPrefilter() const
+{
+    return prefilter_;
+}
+
+DFA Searcher::BuildDFA(const std::vector<RuleCase> &ruleCases)
+{
+    DFA dfa(NFABuilder::Build(ruleCases));
+    DFA::Minimize(dfa);
+    return dfa;
+}
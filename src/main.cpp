@@ -91,6 +91,6 @@ int main()
     // }
     // catch(std::exception& e)
     // {
-    //     DBG << e.what() << std::endl;
+    //     TRACE(INFO, e.what() << std::endl);
     // }
 }
@@ -0,0 +1,266 @@
+/// @file CodeGenTests.cpp
+/// @brief Tests of CodeGen. The generated scanners are compiled with TEST_CXX (the
+///        compiler of the tests), run, and checked against Scanner
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "CodeGen.hpp"
+#include "DFA.hpp"
+#include "NFABuilder.hpp"
+#include "Scanner.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Fixtures;
+
+/// @brief a directory of its own, removed when destroyed
+struct TempDir
+{
+    TempDir(std::string_view name)
+        : path(std::filesystem::temp_directory_path() /
+            std::format("lexer-tests-{}-{}", name, ::getpid()))
+    {
+        std::filesystem::create_directories(path);
+    }
+
+    ~TempDir() { std::filesystem::remove_all(path); }
+
+    std::filesystem::path path;
+};
+
+/// @brief make a rule with an action
+static RuleCase ActionRule(RuleCase::Pattern_t type, std::string pattern, std::string alias,
+    std::string action)
+{
+    return RuleCase{ .patternData = std::move(pattern), .patternType = type,
+        .matchAlias = std::move(alias), .actionCode = std::move(action) };
+}
+
+/// @brief the source of the smallest rule set with an end of file case, as generated
+static constexpr std::string_view GOLDEN_SOURCE =
+R"(// Generated by LexerGenLib. Do not edit.
+
+#include "lexer.hpp"
+
+namespace lexer
+{
+Token Scan(std::string_view input, std::size_t offset)
+{
+    const unsigned char* const data = reinterpret_cast<const unsigned char*>(input.data());
+    const unsigned char* const begin = data + offset;
+    const unsigned char* const end = data + input.size();
+    const unsigned char* p = begin;
+    const unsigned char* matchEnd = begin;
+    std::size_t matchCase = NO_CASE;
+
+    /// the start state accepting is skipped, a token can never be empty
+    goto start;
+
+start:
+    if (p == end) goto done;
+    switch (*p++)
+    {
+    case 97:
+        goto state2;
+    case 98:
+        goto state3;
+    default:
+        goto done;
+    }
+
+state2:
+    if (p == end) goto done;
+    switch (*p++)
+    {
+    case 98:
+        goto state4;
+    default:
+        goto done;
+    }
+
+state3:
+    matchCase = 2;
+    matchEnd = p;
+    if (p == end) goto done;
+    switch (*p++)
+    {
+    default:
+        goto done;
+    }
+
+state4:
+    matchCase = 0;
+    matchEnd = p;
+    if (p == end) goto done;
+    switch (*p++)
+    {
+    default:
+        goto done;
+    }
+
+done:
+    if (matchEnd == begin) return Token{ NO_CASE, offset, 1 };
+    return Token{ matchCase, offset, static_cast<std::size_t>(matchEnd - begin) };
+}
+
+int Lex(std::string_view input, std::size_t& offset)
+{
+    while (offset < input.size())
+    {
+        const Token token = Scan(input, offset);
+        [[maybe_unused]] const std::string_view lexeme = input.substr(token.offset, token.length);
+        offset += token.length;
+
+        switch (token.caseTag)
+        {
+        case 0:
+        {
+            return 1;
+        }
+            break;
+        case 2:
+        {
+            [[maybe_unused]] const std::string_view text = lexeme;
+            return 2;
+        }
+            break;
+        default:
+            break;
+        }
+    }
+
+    [[maybe_unused]] const std::string_view lexeme = input.substr(input.size());
+    {
+        [[maybe_unused]] const std::string_view eof = lexeme;
+        return -1;
+    }
+    return 0;
+}
+}
+)";
+
+TEST_CASE(EmitSourceMatchesGolden)
+{
+    /// the end of file case keeps its case number, so the case after it is 2
+    ///
+    const std::vector<RuleCase> rules = {
+        ActionRule(RuleCase::Pattern_t::REGEX, "ab", "", "return 1;"),
+        ActionRule(RuleCase::Pattern_t::END_OF_FILE, "", "eof", "return -1;"),
+        ActionRule(RuleCase::Pattern_t::REGEX, "b", "text", "return 2;")
+    };
+    DFA dfa(NFABuilder::Build(rules));
+    DFA::Minimize(dfa);
+
+    std::ostringstream source;
+    CodeGen::EmitSource(dfa, rules, source, CodeGen::Options{ });
+    CHECK(source.str() == GOLDEN_SOURCE);
+}
+
+/// @brief a program printing every token Scan finds in a file, then every value
+///        Lex returns until the end of file action runs
+static constexpr std::string_view DRIVER_SOURCE =
+R"(#include "lexer.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) return 1;
+    std::ifstream file(argv[1], std::ios::binary);
+    const std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    for (std::size_t offset = 0; offset < input.size();)
+    {
+        const lexer::Token token = lexer::Scan(input, offset);
+        std::printf("%zu %zu %zu\n", token.caseTag, token.offset, token.length);
+        offset += token.length;
+    }
+
+    std::size_t offset = 0;
+    for (int value = 0; value != -1;)
+    {
+        value = lexer::Lex(input, offset);
+        std::printf("%d\n", value);
+    }
+    return 0;
+}
+)";
+
+TEST_CASE(GeneratedScannerMatchesScanner)
+{
+    const std::vector<RuleCase> rules = {
+        ActionRule(RuleCase::Pattern_t::REGEX, "if", "", "return 5;"),
+        ActionRule(RuleCase::Pattern_t::REGEX, "[a-z_][a-z0-9_]*", "name", "return name.empty() ? 0 : 1;"),
+        ActionRule(RuleCase::Pattern_t::REGEX, "[0-9][0-9]*", "", "return 2;"),
+        ActionRule(RuleCase::Pattern_t::END_OF_FILE, "", "", "return -1;"),
+        ActionRule(RuleCase::Pattern_t::REGEX, "[ \t][ \t]*", "", ""),
+        ActionRule(RuleCase::Pattern_t::REGEX, "\"[^\"]*\"", "", "return 4;")
+    };
+    const std::map<size_t, int> valueOf = { { 0, 5 }, { 1, 1 }, { 2, 2 }, { 5, 4 } };
+    DFA dfa(NFABuilder::Build(rules));
+    DFA::Minimize(dfa);
+
+    TempDir dir("codegen");
+    const std::filesystem::path header = dir.path / "lexer.hpp", source = dir.path / "lexer.cpp";
+    const std::filesystem::path driver = dir.path / "driver.cpp", program = dir.path / "scanner";
+    CodeGen::Emit(dfa, rules, header.c_str(), source.c_str(), CodeGen::Options{ });
+    std::ofstream(driver) << DRIVER_SOURCE;
+
+    /// the generated code compiles warning free
+    ///
+    const std::string compile = std::format("{} -std=c++20 -Wall -Wextra -Werror -I{} {} {} -o {}",
+        TEST_CXX, dir.path.string(), source.string(), driver.string(), program.string());
+    REQUIRE(std::system(compile.c_str()) == 0);
+
+    for (unsigned seed = 0; seed < 3; ++seed)
+    {
+        const std::string input = RandomInput("if ab_09\"\t#", 2000, seed);
+        const std::filesystem::path inputPath = dir.path / "input", outputPath = dir.path / "output";
+        std::ofstream(inputPath, std::ios::binary) << input;
+        const std::string run = std::format("{} {} > {}", program.string(), inputPath.string(),
+            outputPath.string());
+        REQUIRE(std::system(run.c_str()) == 0);
+
+        /// Scan finds the tokens of a Scanner, and Lex returns the value of every
+        /// token with an action that returns, then the end of file value
+        ///
+        const std::vector<Token> expected = ScanAll(dfa, input);
+        std::vector<int> expectedValues;
+        for (const Token& token : expected)
+        {
+            if (auto found = valueOf.find(token.caseTag); found != valueOf.end())
+            {
+                expectedValues.push_back(found->second);
+            }
+        }
+        expectedValues.push_back(-1);
+
+        std::ifstream output(outputPath);
+        std::vector<Token> tokens(expected.size());
+        for (Token& token : tokens)
+        {
+            output >> token.caseTag >> token.offset >> token.length;
+        }
+        std::vector<int> values(expectedValues.size());
+        for (int& value : values)
+        {
+            output >> value;
+        }
+        REQUIRE(output.good());
+        CHECK(SameTokens(tokens, expected));
+        CHECK(values == expectedValues);
+    }
+}
@@ -0,0 +1,63 @@
+/// @file CountersTests.cpp
+/// @brief Tests of Counters
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "Counters.hpp"
+#include "DFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+
+#include <memory_resource>
+#include <vector>
+
+using enum Counters::Counter_t;
+
+TEST_CASE(CountersBatchFlushesWhenDestroyed)
+{
+    Counters::Reset();
+    {
+        Counters::Batch counts;
+        counts[SPLITS] += 3;
+        ++counts[CLOSURES];
+        CHECK(Counters::Snapshot()[SPLITS] == 0);
+    }
+    Counters::Add(SPLITS, 2);
+
+    const Counters::Values values = Counters::Snapshot();
+    CHECK(values[SPLITS] == 5);
+    CHECK(values[CLOSURES] == 1);
+    CHECK(values[DFA_STATES] == 0);
+
+    Counters::Reset();
+    for (size_t counterI = 0; counterI < Counters::NUM_COUNTERS; ++counterI)
+    {
+        CHECK(Counters::Snapshot().values[counterI] == 0);
+    }
+}
+
+TEST_CASE(CountersResourceCountsBytes)
+{
+    Counters::Reset();
+    {
+        std::pmr::vector<char> bytes(Counters::Resource());
+        bytes.reserve(1000);
+    }
+    CHECK(Counters::Snapshot()[BYTES_ALLOCATED] >= 1000);
+}
+
+TEST_CASE(CountersCountConstruction)
+{
+    Counters::Reset();
+    const NFA nfa = NFABuilder::Build({ Fixtures::RegexRule("(a|b)*.a.b.b"), Fixtures::RegexRule("[0-9][0-9]*") });
+    DFA dfa(nfa);
+    DFA::Minimize(dfa);
+
+    const Counters::Values values = Counters::Snapshot();
+    CHECK(values[NFA_STATES] == nfa.states.size());
+    CHECK(values[DFA_STATES] >= dfa.States().size());
+    CHECK(values[CLOSURES] > 0);
+    CHECK(values[WORKLIST_PUSHES] > 0);
+    CHECK(values[BYTES_ALLOCATED] > 0);
+}
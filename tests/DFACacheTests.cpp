@@ -0,0 +1,127 @@
+/// @file DFACacheTests.cpp
+/// @brief Tests of DFACache and DFAImage
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "DFACache.hpp"
+#include "DFAImage.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+#include "Scanner.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Fixtures;
+
+/// @brief a cache directory of its own, removed with the cache
+struct TempCache
+{
+    TempCache(std::string_view name)
+        : directory((std::filesystem::temp_directory_path() / 
+            std::format("lexer-tests-{}-{}", name, ::getpid())).string()), 
+          cache(directory) { }
+
+    ~TempCache() { std::filesystem::remove_all(directory); }
+
+    std::string directory;
+    DFACache cache;
+};
+
+/// @brief tokenize a whole input with the tables of an image
+static std::vector<Token> ScanImage(const DFAImage& image, std::string_view input)
+{
+    DFA::Tables tables = image.View();
+    Scanner scanner(tables, input);
+    std::vector<Token> ret;
+    Token token;
+    while (scanner.Next(token))
+    {
+        ret.push_back(token);
+    }
+    return ret;
+}
+
+TEST_CASE(CacheHitsOnSameRules)
+{
+    TempCache temp("hit");
+    const std::vector<RuleCase> rules = { RegexRule("if"), RegexRule("[a-z][a-z0-9]*") };
+    const std::string input = RandomInput("if09az ", 500, 3);
+
+    const DFAImage first = temp.cache.Load(rules);
+    const DFAImage second = temp.cache.Load(rules);
+    CHECK(temp.cache.Statistics().misses == 1);
+    CHECK(temp.cache.Statistics().hits == 1);
+    CHECK(SameTokens(ScanImage(second, input), ReferenceTokens(NFABuilder::Build(rules), input)));
+}
+
+TEST_CASE(ImageRoundTrips)
+{
+    const std::vector<RuleCase> rules = { RegexRule("(dog)|(cat)"), RegexRule("[a-z_][a-z0-9_]*"),
+        RegexRule("[^a-z0-9]") };
+    DFA dfa(NFABuilder::Build(rules));
+    DFA::Minimize(dfa);
+
+    const std::string path = (std::filesystem::temp_directory_path() / 
+        std::format("lexer-tests-image-{}.dfa", ::getpid())).string();
+    /// rules of a length that needs padding
+    ///
+    const std::string normalized = DFACache::Normalized(rules) + "x";
+    DFAImage::Write(dfa, path.c_str(), normalized);
+    const DFAImage image(path.c_str());
+    CHECK(image.NumStates() == dfa.States().size());
+    CHECK(image.Rules() == normalized);
+
+    const std::string input = RandomInput("dogcat_09 +", 500, 5);
+    CHECK(SameTokens(ScanImage(image, input), ScanAll(dfa, input)));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE(CacheRejectsImageOfOtherRules)
+{
+    /// an image of other rules at the path of a key, as a hash collision (or an
+    /// image of an older compiler) would leave it, is rebuilt rather than served
+    ///
+    TempCache temp("collision");
+    const std::vector<RuleCase> rules = { RegexRule("if"), RegexRule("[a-z][a-z0-9]*") };
+    const std::vector<RuleCase> others = { RegexRule("[0-9][0-9]*") };
+    DFA dfa(NFABuilder::Build(others));
+    DFA::Minimize(dfa);
+    const std::string path = temp.cache.PathOf(DFACache::Key(rules));
+    DFAImage::Write(dfa, path.c_str(), DFACache::Normalized(others));
+
+    const std::string input = RandomInput("if09az ", 500, 4);
+    const DFAImage first = temp.cache.Load(rules);
+    CHECK(temp.cache.Statistics().misses == 1);
+    CHECK(temp.cache.Statistics().hits == 0);
+    CHECK(first.Rules() == DFACache::Normalized(rules));
+    CHECK(SameTokens(ScanImage(first, input), ReferenceTokens(NFABuilder::Build(rules), input)));
+
+    const DFAImage second = temp.cache.Load(rules);
+    CHECK(temp.cache.Statistics().hits == 1);
+}
+
+TEST_CASE(CacheKeyHasCompilerVersion)
+{
+    const std::vector<RuleCase> rules = { RegexRule("if") };
+    const std::string normalized = DFACache::Normalized(rules);
+    REQUIRE(normalized.size() >= sizeof(uint64_t));
+    uint64_t version = 0;
+    std::memcpy(&version, normalized.data(), sizeof(version));
+    CHECK(version == DFACache::COMPILER_VERSION);
+    CHECK(DFACache::Key(rules) == DFACache::Key(normalized));
+
+    /// action code is not part of the key
+    ///
+    RuleCase withAction = RegexRule("if");
+    withAction.actionCode = "return 1;";
+    CHECK(DFACache::Key({ withAction }) == DFACache::Key(rules));
+}
@@ -0,0 +1,41 @@
+/// @file DFATests.cpp
+/// @brief Tests of DFA
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+
+#include <vector>
+
+using namespace Fixtures;
+
+/// @brief rule sets the constructions are compared on
+static std::vector<std::vector<RuleCase>> RuleSets()
+{
+    return {
+        { RegexRule("(a|b)*.a.b.b") },
+        { RegexRule("if"), RegexRule("[a-z][a-z0-9]*"), RegexRule("[0-9][0-9]*") },
+        { RegexRule("(dog)|(cat)"), RegexRule("[a-c]*x"), RegexRule("[0-9][0-9a-f]*"), 
+          RegexRule("if|else|while"), RegexRule("[a-z_][a-z0-9_]*"), RegexRule("[^a-z0-9]") },
+        { RegexRule("(a|b)*.a.(a|b).(a|b).(a|b).(a|b).(a|b)") }
+    };
+}
+
+TEST_CASE(PowersetMatchesReference)
+{
+    for (const std::vector<RuleCase>& rules : RuleSets())
+    {
+        const NFA nfa = NFABuilder::Build(rules);
+        const std::string input = RandomInput("abdogcatxif09f_ +\tZ", 2000, 2);
+        const std::vector<Token> reference = ReferenceTokens(nfa, input);
+
+        DFA minimized(nfa, 4);
+        DFA::Minimize(minimized);
+        CHECK(SameTokens(ScanAll(DFA(nfa), input), reference));
+        CHECK(SameTokens(ScanAll(DFA(nfa, 4), input), reference));
+        CHECK(SameTokens(ScanAll(minimized, input), reference));
+    }
+}
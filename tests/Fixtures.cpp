@@ -0,0 +1,130 @@
+/// @file Fixtures.cpp
+/// @brief Provides the definitions of the test fixtures
+
+#include "Fixtures.hpp"
+
+#include "DFA.hpp"
+#include "NFA.hpp"
+
+#include "LexerUtil/Constants.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+
+/// @brief get the epsilon closure of a set of nfa states
+static std::set<size_t> ClosureOf(const NFA& nfa, std::set<size_t> set)
+{
+    std::vector<size_t> work(set.begin(), set.end());
+    while (!work.empty())
+    {
+        const size_t state = work.back();
+        work.pop_back();
+        for (const NFA::Transition& transition : nfa.states[state].transitions)
+        {
+            if (transition.IsEpsilon() && set.insert(transition.to).second)
+            {
+                work.push_back(transition.to);
+            }
+        }
+    }
+    return set;
+}
+
+/// @brief get the lowest case tag accepted by a set of nfa states
+static size_t CaseTagOf(const NFA& nfa, const std::set<size_t>& set)
+{
+    size_t ret = NO_CASE_TAG;
+    for (size_t state : set)
+    {
+        if (nfa.accept.contains(state)) ret = std::min(ret, nfa.states[state].caseTag);
+    }
+    return ret;
+}
+
+RuleCase Fixtures::RegexRule(std::string pattern)
+{
+    return RuleCase{
+        .patternData = std::move(pattern),
+        .patternType = RuleCase::Pattern_t::REGEX,
+        .matchAlias = "",
+        .actionCode = ""
+    };
+}
+
+RuleCase Fixtures::EmptyRule(RuleCase::Pattern_t type)
+{
+    return RuleCase{ .patternData = "", .patternType = type, .matchAlias = "", .actionCode = "" };
+}
+
+std::string Fixtures::RandomInput(std::string_view bytes, size_t size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> pick(0, bytes.size() - 1);
+    std::string ret(size, '\0');
+    for (char& byte : ret)
+    {
+        byte = bytes[pick(generator)];
+    }
+    return ret;
+}
+
+std::vector<Token> Fixtures::ScanAll(const DFA& dfa, std::string_view input)
+{
+    Scanner scanner(dfa, input);
+    std::vector<Token> ret;
+    Token token;
+    while (scanner.Next(token))
+    {
+        ret.push_back(token);
+    }
+    return ret;
+}
+
+std::vector<Token> Fixtures::ReferenceTokens(const NFA& nfa, std::string_view input)
+{
+    std::vector<Token> ret;
+    for (size_t offset = 0; offset < input.size();)
+    {
+        /// keep the longest accepted prefix, ties going to the lowest case
+        ///
+        std::set<size_t> live = ClosureOf(nfa, { nfa.start });
+        size_t caseTag = NO_CASE_TAG, length = 0;
+        for (size_t byteI = offset; byteI < input.size() && !live.empty(); ++byteI)
+        {
+            const uint8_t byte = static_cast<uint8_t>(input[byteI]);
+            std::set<size_t> next;
+            for (size_t state : (ALPHABET_CLASS.Contains(byte) ? live : std::set<size_t>{ }))
+            {
+                for (const NFA::Transition& transition : nfa.states[state].transitions)
+                {
+                    if (!transition.IsEpsilon() && static_cast<uint8_t>(transition.lo) <= byte 
+                        && byte <= static_cast<uint8_t>(transition.hi))
+                    {
+                        next.insert(transition.to);
+                    }
+                }
+            }
+            live = ClosureOf(nfa, std::move(next));
+            if (const size_t tag = CaseTagOf(nfa, live); tag != NO_CASE_TAG)
+            {
+                caseTag = tag;
+                length = byteI + 1 - offset;
+            }
+        }
+
+        if (length == 0) ret.push_back(Token{ .caseTag = NO_CASE_TAG, .offset = offset, .length = 1 });
+        else ret.push_back(Token{ .caseTag = caseTag, .offset = offset, .length = length });
+        offset += ret.back().length;
+    }
+    return ret;
+}
+
+bool Fixtures::SameTokens(const std::vector<Token>& left, const std::vector<Token>& right)
+{
+    return std::ranges::equal(left, right, [](const Token& a, const Token& b)
+    {
+        return a.caseTag == b.caseTag && a.offset == b.offset && a.length == b.length;
+    });
+}
@@ -0,0 +1,40 @@
+/// @file Fixtures.hpp
+/// @brief Provides the rules, inputs and reference results shared by the tests
+
+#pragma once
+
+#include "RuleCase.hpp"
+#include "Scanner.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DFA;
+struct NFA;
+
+namespace Fixtures
+{
+    /// @brief make a regex rule
+    RuleCase RegexRule(std::string pattern);
+
+    /// @brief make a rule of a type without a pattern (END_OF_FILE or NONE)
+    RuleCase EmptyRule(RuleCase::Pattern_t type);
+
+    /// @brief make a random input of bytes drawn from a set
+    /// @param bytes the bytes to draw from
+    /// @param size the size of the input
+    /// @param seed the seed of the generator, so inputs are reproducible
+    std::string RandomInput(std::string_view bytes, size_t size, unsigned seed);
+
+    /// @brief tokenize a whole input with a Scanner
+    std::vector<Token> ScanAll(const DFA& dfa, std::string_view input);
+
+    /// @brief tokenize a whole input by simulating an nfa directly on sets of states,
+    ///        the reference the engines are checked against
+    std::vector<Token> ReferenceTokens(const NFA& nfa, std::string_view input);
+
+    /// @brief check if two token streams are identical
+    bool SameTokens(const std::vector<Token>& left, const std::vector<Token>& right);
+};
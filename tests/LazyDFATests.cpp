@@ -0,0 +1,75 @@
+/// @file LazyDFATests.cpp
+/// @brief Tests of LazyDFA
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "CompactNFA.hpp"
+#include "DFA.hpp"
+#include "LazyDFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Fixtures;
+
+TEST_CASE(LazyDFAMatchesScanner)
+{
+    const NFA nfa = NFABuilder::Build({ RegexRule("(dog)|(cat)"), RegexRule("[a-c]*x"), 
+        RegexRule("if|else|while"), RegexRule("[a-z_][a-z0-9_]*"), RegexRule("[^a-z0-9]") });
+    DFA dfa(nfa);
+    const std::string input = RandomInput("dogcatabcxif elsewhile_09+", 5000, 6);
+
+    LazyDFA lazy(nfa);
+    CHECK(SameTokens(lazy.Tokenize(input), ScanAll(dfa, input)));
+    CHECK(!lazy.Statistics().fellBack);
+    CHECK(lazy.Statistics().flushes == 0);
+}
+
+TEST_CASE(LazyDFAFallsBackWhenThrashing)
+{
+    /// the dfa of this pattern has 2^10 states, far more than the cache holds
+    ///
+    const NFA nfa = NFABuilder::Build({ RegexRule("(a|b)*.a.(a|b).(a|b).(a|b).(a|b).(a|b).(a|b)"
+        ".(a|b).(a|b).(a|b)"), RegexRule("b") });
+    DFA dfa(nfa);
+    const std::string input = RandomInput("ab", 20000, 7);
+
+    LazyDFA lazy(nfa, 4);
+    CHECK(SameTokens(lazy.Tokenize(input), ScanAll(dfa, input)));
+    CHECK(lazy.Statistics().fellBack);
+    CHECK(lazy.Statistics().flushes >= 3);
+}
+
+TEST_CASE(CompactNFAClosuresAreEpsilonClosures)
+{
+    const CompactNFA nfa(NFABuilder::Build({ RegexRule("((a*)*b)*"), RegexRule("(a|b)*c") }));
+    const CompactNFA::Closures closures = nfa.EpsilonClosures();
+    REQUIRE(closures.begin.size() == nfa.NumStates() + 1);
+    REQUIRE(closures.begin.back() == closures.states.size());
+
+    /// every closure starts with its state, holds no state twice, and holds
+    /// the target of every epsilon edge of its states
+    ///
+    for (uint32_t stateI = 0; stateI < nfa.NumStates(); ++stateI)
+    {
+        std::vector<uint32_t> closure(closures.states.begin() + closures.begin[stateI],
+            closures.states.begin() + closures.begin[stateI + 1]);
+        REQUIRE(!closure.empty());
+        CHECK(closure.front() == stateI);
+
+        std::vector<uint32_t> sorted = closure;
+        std::ranges::sort(sorted);
+        CHECK(std::ranges::adjacent_find(sorted) == sorted.end());
+        for (uint32_t member : closure)
+        {
+            for (uint32_t e = nfa.epsilonBegin[member]; e < nfa.epsilonBegin[member + 1]; ++e)
+            {
+                CHECK(std::ranges::binary_search(sorted, nfa.epsilonTargets[e]));
+            }
+        }
+    }
+}
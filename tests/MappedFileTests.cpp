@@ -0,0 +1,117 @@
+/// @file MappedFileTests.cpp
+/// @brief Tests of MappedFile and FileScanner
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "MappedFile.hpp"
+#include "NFABuilder.hpp"
+#include "Scanner.hpp"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Fixtures;
+
+/// @brief a file of its own holding some contents, removed when destroyed
+struct TempFile
+{
+    TempFile(std::string_view name, std::string_view contents)
+        : path((std::filesystem::temp_directory_path() /
+            std::format("lexer-tests-{}-{}", name, ::getpid())).string())
+    {
+        std::ofstream(path, std::ios::binary).write(contents.data(), contents.size());
+    }
+
+    ~TempFile() { std::filesystem::remove(path); }
+
+    std::string path;
+};
+
+/// @brief tokenize a whole file with a FileScanner
+static std::vector<Token> ScanFile(const DFA& dfa, const char* path)
+{
+    FileScanner scanner(dfa, path);
+    std::vector<Token> ret;
+    Token token;
+    while (scanner.Next(token))
+    {
+        REQUIRE(scanner.Lexeme(token) == scanner.Input().substr(token.offset, token.length));
+        ret.push_back(token);
+    }
+    return ret;
+}
+
+TEST_CASE(FileScannerMatchesScanner)
+{
+    DFA dfa(NFABuilder::Build({ RegexRule("if"), RegexRule("[a-z][a-z0-9]*"),
+        RegexRule("[0-9][0-9]*"), RegexRule("[ \n][ \n]*") }));
+    DFA::Minimize(dfa);
+
+    /// a size past a page, and one ending exactly on a page boundary
+    ///
+    for (size_t size : { 1, 100, 4096, 10000 })
+    {
+        const std::string input = RandomInput("if09az \n#", size, 4);
+        TempFile file("scan", input);
+
+        MappedFile mapped(file.path.c_str());
+        CHECK(mapped.Size() == input.size());
+        CHECK(mapped.View() == input);
+        CHECK(SameTokens(ScanFile(dfa, file.path.c_str()), ScanAll(dfa, input)));
+    }
+}
+
+TEST_CASE(FileScannerScansEmptyFile)
+{
+    DFA dfa(NFABuilder::Build({ RegexRule("[a-z][a-z]*") }));
+    TempFile file("empty", "");
+
+    MappedFile mapped(file.path.c_str());
+    CHECK(mapped.Size() == 0);
+    CHECK(mapped.View().empty());
+
+    FileScanner scanner(dfa, file.path.c_str());
+    Token token;
+    CHECK(scanner.Input().empty());
+    CHECK(!scanner.Next(token));
+}
+
+TEST_CASE(FileScannerThrowsOnMissingFile)
+{
+    DFA dfa(NFABuilder::Build({ RegexRule("[a-z][a-z]*") }));
+    const std::string path = (std::filesystem::temp_directory_path() /
+        std::format("lexer-tests-missing-{}", ::getpid())).string();
+
+    bool threw = false;
+    try
+    {
+        FileScanner scanner(dfa, path.c_str());
+    }
+    catch ( std::invalid_argument& e )
+    {
+        threw = std::string_view(e.what()).find(path) != std::string_view::npos;
+    }
+    CHECK(threw);
+}
+
+TEST_CASE(MappedFileMoves)
+{
+    TempFile file("move", "abc");
+    MappedFile first(file.path.c_str());
+    MappedFile second(std::move(first));
+    CHECK(first.View().empty());
+    CHECK(second.View() == "abc");
+
+    first = std::move(second);
+    CHECK(first.View() == "abc");
+    CHECK(second.Size() == 0);
+}
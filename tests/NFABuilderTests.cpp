@@ -0,0 +1,61 @@
+/// @file NFABuilderTests.cpp
+/// @brief Tests of NFABuilder
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "LazyDFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+#include "NFAOptimizer.hpp"
+#include "PikeVM.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Fixtures;
+
+TEST_CASE(EmptyRulesBuild)
+{
+    /// cases without a pattern match nothing, but keep their case number, so the
+    /// rules after them are still told apart
+    ///
+    const NFA nfa = NFABuilder::Build({ RegexRule("a*b"), EmptyRule(RuleCase::Pattern_t::END_OF_FILE),
+        RegexRule("[0-9][0-9]*"), EmptyRule(RuleCase::Pattern_t::NONE) });
+    REQUIRE(nfa.numCases == 4);
+    REQUIRE(nfa.accept.size() == 2);
+    for (const NFA::State& state : nfa.states)
+    {
+        for (const NFA::Transition& transition : state.transitions)
+        {
+            REQUIRE(transition.to < nfa.states.size());
+        }
+    }
+
+    const std::string input = RandomInput("ab09 ", 2000, 3);
+    const std::vector<Token> reference = ReferenceTokens(nfa, input);
+    CHECK(std::ranges::any_of(reference, [](const Token& token) { return token.caseTag == 2; }));
+
+    DFA minimized(nfa);
+    DFA::Minimize(minimized);
+    CHECK(SameTokens(ScanAll(DFA(nfa), input), reference));
+    CHECK(SameTokens(ScanAll(DFA(nfa, 4), input), reference));
+    CHECK(SameTokens(ScanAll(minimized, input), reference));
+    CHECK(SameTokens(ScanAll(DFA(NFAOptimizer::RemoveEpsilons(nfa)), input), reference));
+    CHECK(SameTokens(PikeVM(nfa).Tokenize(input), reference));
+    CHECK(SameTokens(LazyDFA(nfa).Tokenize(input), reference));
+}
+
+TEST_CASE(OnlyEmptyRulesBuild)
+{
+    const NFA nfa = NFABuilder::Build({ EmptyRule(RuleCase::Pattern_t::END_OF_FILE) });
+    CHECK(nfa.accept.empty());
+
+    const std::string input = "ab";
+    const std::vector<Token> reference = ReferenceTokens(nfa, input);
+    CHECK(SameTokens(ScanAll(DFA(nfa), input), reference));
+    CHECK(SameTokens(PikeVM(nfa).Tokenize(input), reference));
+    CHECK(SameTokens(LazyDFA(nfa).Tokenize(input), reference));
+}
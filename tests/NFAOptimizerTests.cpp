@@ -0,0 +1,69 @@
+/// @file NFAOptimizerTests.cpp
+/// @brief Tests of NFAOptimizer, and of the engines built with and without it
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+#include "NFAOptimizer.hpp"
+#include "PikeVM.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace Fixtures;
+
+/// @brief rule sets with nested stars, shared prefixes and overlapping cases,
+///        whose epsilon closures are not trivial
+static std::vector<std::vector<RuleCase>> RuleSets()
+{
+    return {
+        { RegexRule("(dog)|(cat)"), RegexRule("[a-c]*x"), RegexRule("[0-9][0-9a-f]*"), 
+          RegexRule("if|else|while"), RegexRule("[a-z_][a-z0-9_]*"), RegexRule("[^a-z0-9]") },
+        { RegexRule("((a|b)*c)*"), RegexRule("(a*)*b"), RegexRule("a(b|c)*|ab*") },
+        { RegexRule("(a|b)*.a.(a|b).(a|b).(a|b).(a|b)"), RegexRule("b") }
+    };
+}
+
+TEST_CASE(RemoveEpsilonsLeavesNoEpsilons)
+{
+    for (const std::vector<RuleCase>& rules : RuleSets())
+    {
+        const NFA nfa = NFABuilder::Build(rules);
+        const NFA optimized = NFAOptimizer::RemoveEpsilons(nfa);
+        CHECK(optimized.numCases == nfa.numCases);
+        CHECK(optimized.states.size() <= nfa.states.size());
+        for (const NFA::State& state : optimized.states)
+        {
+            for (const NFA::Transition& transition : state.transitions)
+            {
+                CHECK(!transition.IsEpsilon());
+                CHECK(transition.to < optimized.states.size());
+            }
+        }
+
+        const std::string input = RandomInput("abcxdogif09_-\t ", 1500, 8);
+        CHECK(SameTokens(ReferenceTokens(optimized, input), ReferenceTokens(nfa, input)));
+    }
+}
+
+TEST_CASE(EnginesMatchWithAndWithoutRemoveEpsilons)
+{
+    for (const std::vector<RuleCase>& rules : RuleSets())
+    {
+        const NFA nfa = NFABuilder::Build(rules);
+        const NFA optimized = NFAOptimizer::RemoveEpsilons(nfa);
+        const std::string input = RandomInput("abcxdogif09_-\t ", 3000, 9);
+        const std::vector<Token> reference = ReferenceTokens(nfa, input);
+
+        DFA minimized(optimized);
+        DFA::Minimize(minimized);
+        PikeVM vm(optimized);
+        CHECK(SameTokens(ScanAll(DFA(optimized), input), reference));
+        CHECK(SameTokens(ScanAll(DFA(optimized, 4), input), reference));
+        CHECK(SameTokens(ScanAll(minimized, input), reference));
+        CHECK(SameTokens(vm.Tokenize(input), reference));
+    }
+}
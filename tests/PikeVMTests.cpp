@@ -0,0 +1,56 @@
+/// @file PikeVMTests.cpp
+/// @brief Tests of PikeVM
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+#include "PikeVM.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace Fixtures;
+
+TEST_CASE(PikeVMMatchesScanner)
+{
+    const std::vector<std::vector<RuleCase>> ruleSets = {
+        { RegexRule("(dog)|(cat)"), RegexRule("[a-c]*x"), RegexRule("[0-9][0-9a-f]*"), 
+          RegexRule("if|else|while"), RegexRule("[a-z_][a-z0-9_]*"), RegexRule("[^a-z0-9]") },
+        { RegexRule("\\d\\d*"), RegexRule("[\\w\\-]x"), RegexRule("\\s"), RegexRule("[^\\d\\s]") },
+        { RegexRule("(a|b)*.a.(a|b).(a|b).(a|b).(a|b)"), RegexRule("b") }
+    };
+    for (const std::vector<RuleCase>& rules : ruleSets)
+    {
+        const NFA nfa = NFABuilder::Build(rules);
+        DFA dfa(nfa);
+        DFA::Minimize(dfa);
+        PikeVM vm(nfa);
+        for (unsigned seed = 0; seed < 4; ++seed)
+        {
+            const std::string input = RandomInput("abdogcatxif elsewhile_09f+*(\t-Z\r", 3000, seed);
+            CHECK(SameTokens(vm.Tokenize(input), ScanAll(dfa, input)));
+        }
+    }
+}
+
+TEST_CASE(PikeVMMunchesAtEveryOffset)
+{
+    const NFA nfa = NFABuilder::Build({ RegexRule("ab*"), RegexRule("abc"), RegexRule("[a-c]") });
+    DFA dfa(nfa);
+    PikeVM vm(nfa);
+    const std::string input = RandomInput("abcd", 200, 1);
+    for (size_t offset = 0; offset < input.size(); ++offset)
+    {
+        Scanner scanner(dfa, std::string_view(input).substr(offset));
+        Token expected;
+        REQUIRE(scanner.Next(expected));
+
+        const Token token = vm.MunchAt(input, offset);
+        CHECK(token.caseTag == expected.caseTag);
+        CHECK(token.offset == offset);
+        CHECK(token.length == expected.length);
+    }
+}
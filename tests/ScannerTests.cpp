@@ -0,0 +1,96 @@
+/// @file ScannerTests.cpp
+/// @brief Tests of Scanner
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "NFA.hpp"
+#include "NFABuilder.hpp"
+#include "Scanner.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace Fixtures;
+
+/// @brief rules with long tokens (comments, strings) whose starts are ambiguous
+///        mid-buffer, so the chunks of a parallel scan start out of sync
+static std::vector<RuleCase> ScanRules()
+{
+    return { RegexRule("/\\*([^*]|\\*[^/])*\\*/"), RegexRule("\"[^\"]*\""), 
+        RegexRule("[a-z_][a-z0-9_]*"), RegexRule("[0-9][0-9]*"), RegexRule("[ \t][ \t]*"),
+        RegexRule("/"), RegexRule("\\*") };
+}
+
+TEST_CASE(ScannerMatchesReference)
+{
+    const NFA nfa = NFABuilder::Build(ScanRules());
+    DFA dfa(nfa);
+    DFA::Minimize(dfa);
+    for (unsigned seed = 0; seed < 4; ++seed)
+    {
+        const std::string input = RandomInput("/*ab_09\" \t#", 3000, seed);
+        CHECK(SameTokens(ScanAll(dfa, input), ReferenceTokens(nfa, input)));
+    }
+}
+
+TEST_CASE(ScanParallelMatchesNext)
+{
+    DFA dfa(NFABuilder::Build(ScanRules()));
+    DFA::Minimize(dfa);
+    /// chunks are at least 64 KiB, so the larger inputs are split 3 and 16 ways
+    ///
+    for (unsigned seed = 0; seed < 3; ++seed)
+    {
+        for (size_t size : { 0, 1, 7, 5000, 200000, 1100000 })
+        {
+            const std::string input = RandomInput("/*ab_09\" \t#", size, seed);
+            const std::vector<Token> sequential = ScanAll(dfa, input);
+            for (size_t numThreads = 1; numThreads <= 16; ++numThreads)
+            {
+                CHECK(SameTokens(Scanner::ScanParallel(dfa.View(), input, numThreads), sequential));
+            }
+        }
+    }
+}
+
+/// @brief tokenize a stream fed in chunks of a given size
+static std::vector<Token> ScanStream(const DFA& dfa, std::string_view input, size_t chunkSize)
+{
+    StreamScanner scanner(dfa);
+    std::vector<Token> ret;
+    Token token;
+    std::string_view lexeme;
+    for (size_t offset = 0; offset < input.size(); offset += chunkSize)
+    {
+        scanner.Feed(input.substr(offset, chunkSize));
+        while (scanner.Next(token, lexeme))
+        {
+            REQUIRE(lexeme == input.substr(token.offset, token.length));
+            ret.push_back(token);
+        }
+    }
+    scanner.Finish();
+    while (scanner.Next(token, lexeme))
+    {
+        REQUIRE(lexeme == input.substr(token.offset, token.length));
+        ret.push_back(token);
+    }
+    return ret;
+}
+
+TEST_CASE(StreamScannerMatchesScanner)
+{
+    DFA dfa(NFABuilder::Build(ScanRules()));
+    DFA::Minimize(dfa);
+    for (unsigned seed = 0; seed < 4; ++seed)
+    {
+        const std::string input = RandomInput("/*ab_09\" \t#", 5000, seed);
+        const std::vector<Token> expected = ScanAll(dfa, input);
+        for (size_t chunkSize : { 1, 2, 3, 7, 64, 1000, 5000 })
+        {
+            CHECK(SameTokens(ScanStream(dfa, input, chunkSize), expected));
+        }
+    }
+}
@@ -0,0 +1,170 @@
+/// @file SearcherTests.cpp
+/// @brief Tests of Prefilter and Searcher
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "NFABuilder.hpp"
+#include "Prefilter.hpp"
+#include "Scanner.hpp"
+#include "Searcher.hpp"
+
+#include "LexerUtil/Constants.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace Fixtures;
+
+/// @brief check if a rule has the expected required factor
+static bool HasFactor(const RuleCase& ruleCase, std::vector<std::string> literals, size_t maxOffset)
+{
+    const std::optional<Prefilter::Factor> factor = Prefilter::RequiredFactor(ruleCase);
+    return factor && factor->literals == literals && factor->maxOffset == maxOffset;
+}
+
+/// @brief check if a rule has no required factor
+static bool HasNoFactor(const RuleCase& ruleCase)
+{
+    return !Prefilter::RequiredFactor(ruleCase).has_value();
+}
+
+TEST_CASE(RequiredFactorOfConcat)
+{
+    CHECK(HasFactor(RegexRule("abc"), { "abc" }, 0));
+    CHECK(HasFactor(RegexRule("x[a-c]y"), { "xay", "xby", "xcy" }, 0));
+
+    /// a bounded offset beats a longer literal, an unbounded one is kept otherwise.
+    /// Concatenation groups to the right, so "abc*" is "a(bc*)", whose factor is "a"
+    ///
+    CHECK(HasFactor(RegexRule("(ab)(c|d)*efgh"), { "ab" }, 0));
+    CHECK(HasFactor(RegexRule("abc*"), { "a" }, 0));
+    CHECK(HasFactor(RegexRule("[a-z]*foo"), { "foo" }, Prefilter::UNBOUNDED));
+
+    /// a wide class has no factor, but still shifts the factor after it
+    ///
+    CHECK(HasFactor(RegexRule("[^a]xy"), { "xy" }, 1));
+    CHECK(HasFactor(RegexRule("[^a][^b]xy"), { "xy" }, 2));
+}
+
+TEST_CASE(RequiredFactorOfUnion)
+{
+    CHECK(HasFactor(RegexRule("cat|dog"), { "cat", "dog" }, 0));
+    CHECK(HasFactor(RegexRule("(ab|cd)(ef|g)"), { "abef", "abg", "cdef", "cdg" }, 0));
+
+    /// the offset of a union is the furthest of either side
+    ///
+    CHECK(HasFactor(RegexRule("([^a]x)|([^a][^a]y)"), { "x", "y" }, 2));
+
+    /// a side without a factor leaves the union without one
+    ///
+    CHECK(HasNoFactor(RegexRule("cat|[a-z]*")));
+    CHECK(HasNoFactor(RegexRule("cat|[^a]")));
+}
+
+TEST_CASE(RequiredFactorOfStar)
+{
+    CHECK(HasNoFactor(RegexRule("(ab)*")));
+    CHECK(HasNoFactor(RegexRule("a*")));
+    CHECK(HasFactor(RegexRule("(ab)*c"), { "c" }, Prefilter::UNBOUNDED));
+}
+
+TEST_CASE(RequiredFactorOfPlus)
+{
+    CHECK(HasFactor(RegexRule("(ab)+"), { "ab" }, 0));
+    CHECK(HasFactor(RegexRule("(ab)+c"), { "ab" }, 0));
+    CHECK(HasFactor(RegexRule("[^a](ab)+"), { "ab" }, 1));
+}
+
+TEST_CASE(RequiredFactorOfOptional)
+{
+    CHECK(HasNoFactor(RegexRule("(ab)?")));
+    CHECK(HasFactor(RegexRule("a?bc"), { "bc" }, 1));
+    CHECK(HasFactor(RegexRule("(xyz)?bc"), { "bc" }, 3));
+}
+
+TEST_CASE(RequiredFactorOfString)
+{
+    const RuleCase shortString{ .patternData = "a*b", .patternType = RuleCase::Pattern_t::STRING,
+        .matchAlias = "", .actionCode = "" };
+    CHECK(HasFactor(shortString, { "a*b" }, 0));
+
+    /// a long literal is cut down to its first MAX_LITERAL_LENGTH bytes
+    ///
+    const RuleCase longString{ .patternData = std::string(40, 'q'),
+        .patternType = RuleCase::Pattern_t::STRING, .matchAlias = "", .actionCode = "" };
+    CHECK(HasFactor(longString, { std::string(Prefilter::MAX_LITERAL_LENGTH, 'q') }, 0));
+}
+
+/// @brief find every match of a text by trying a Scanner at every offset, the
+///        reference the Searcher is checked against
+static std::vector<Token> ReferenceMatches(const std::vector<RuleCase>& rules, std::string_view text)
+{
+    DFA dfa(NFABuilder::Build(rules));
+    std::vector<Token> ret;
+    for (size_t offset = 0; offset < text.size();)
+    {
+        Scanner scanner(dfa, text.substr(offset));
+        Token token;
+        scanner.Next(token);
+        if (token.caseTag == NO_CASE_TAG)
+        {
+            ++offset;
+            continue;
+        }
+        ret.push_back(Token{ .caseTag = token.caseTag, .offset = offset, .length = token.length });
+        offset += token.length;
+    }
+    return ret;
+}
+
+TEST_CASE(SearcherMatchesReference)
+{
+    const RuleCase keyword{ .patternData = "while", .patternType = RuleCase::Pattern_t::STRING,
+        .matchAlias = "", .actionCode = "" };
+    const std::vector<std::vector<RuleCase>> ruleSets = {
+        { RegexRule("foo[a-z]*bar") },
+        { RegexRule("cat|dog"), RegexRule("[0-9][0-9]*x") },
+        { RegexRule("[^a][^b]xy"), RegexRule("x[a-c]y") },
+        { RegexRule("[a-z]*foo"), keyword },
+        { RegexRule("(ab|cd)(ef|g)"), RegexRule("[a-c]*x") },
+        { RegexRule("([^a]x)|([^a][^a]y)"), EmptyRule(RuleCase::Pattern_t::END_OF_FILE) },
+        { RegexRule("(a|b)*") }
+    };
+    for (const std::vector<RuleCase>& rules : ruleSets)
+    {
+        const Searcher searcher(rules);
+        for (unsigned seed = 0; seed < 4; ++seed)
+        {
+            const std::string text = RandomInput("abcdefgortxy09 whil", 3000, seed);
+            CHECK(SameTokens(searcher.FindAll(text), ReferenceMatches(rules, text)));
+        }
+    }
+    CHECK(Searcher({ RegexRule("cat|dog") }).GetPrefilter().has_value());
+    CHECK(!Searcher({ RegexRule("(a|b)*") }).GetPrefilter().has_value());
+}
+
+TEST_CASE(SearcherFindsFromOffset)
+{
+    const std::vector<RuleCase> rules = { RegexRule("[^a][^a]xy") };
+    const Searcher searcher(rules);
+    const std::string text = RandomInput("abxy", 500, 9);
+    const std::vector<Token> reference = ReferenceMatches(rules, text);
+    REQUIRE(!reference.empty());
+    size_t from = 0;
+    for (const Token& expected : reference)
+    {
+        /// every match is found from any offset between the previous match and it
+        ///
+        for (; from <= expected.offset; ++from)
+        {
+            Token match;
+            REQUIRE(searcher.Find(text, from, match));
+            CHECK(match.offset == expected.offset);
+            CHECK(match.length == expected.length);
+        }
+        from = expected.offset + expected.length;
+    }
+}
@@ -0,0 +1,139 @@
+/// @file SimdTests.cpp
+/// @brief Tests of the byte search kernels, against a scalar reference
+
+#include "Test.hpp"
+
+#include "LexerUtil/Simd.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/// @brief byte ranges to search for
+struct Ranges
+{
+    uint8_t lo[4];
+    uint8_t hi[4];
+    size_t count;
+
+    bool Contains(uint8_t byte) const
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (lo[i] <= byte && byte <= hi[i]) return true;
+        }
+        return false;
+    }
+};
+
+/// @brief find the first byte whose membership is the one requested, one byte at a time
+static size_t ReferenceFind(const std::vector<uint8_t>& bytes, const Ranges& ranges, bool member)
+{
+    size_t ret = 0;
+    while (ret < bytes.size() && ranges.Contains(bytes[ret]) != member) ++ret;
+    return ret;
+}
+
+/// @brief make random ranges, some of them above 0x7F, so the signed byte
+///        compares a kernel could get wrong are exercised
+static Ranges RandomRanges(size_t count, std::mt19937& generator)
+{
+    std::uniform_int_distribution<int> pick(0, 255);
+    Ranges ret{ .lo = { }, .hi = { }, .count = count };
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint8_t a = static_cast<uint8_t>(pick(generator)), b = static_cast<uint8_t>(pick(generator));
+        if (i == 0) a |= 0x80;
+        if (a > b) std::swap(a, b);
+        if (b - a > 40) b = a + static_cast<uint8_t>(pick(generator) % 40); /// keep a few non-members
+        ret.lo[i] = a;
+        ret.hi[i] = b;
+    }
+    return ret;
+}
+
+/// @brief check both kernels on a run of bytes, at every small misalignment
+static void CheckKernels(const std::vector<uint8_t>& bytes, const Ranges& ranges)
+{
+    for (size_t shift = 0; shift < 4; ++shift)
+    {
+        std::vector<uint8_t> buffer(shift, 0);
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+        const uint8_t* first = buffer.data() + shift;
+        const uint8_t* last = buffer.data() + buffer.size();
+
+        CHECK(FindInRanges(first, last, ranges.lo, ranges.hi, ranges.count) - first
+            == static_cast<std::ptrdiff_t>(ReferenceFind(bytes, ranges, true)));
+        CHECK(FindNotInRanges(first, last, ranges.lo, ranges.hi, ranges.count) - first
+            == static_cast<std::ptrdiff_t>(ReferenceFind(bytes, ranges, false)));
+    }
+}
+
+TEST_CASE(SimdKernelsMatchReference)
+{
+    /// lengths around the 16 and 32 byte vector widths, so the vector loops and
+    /// the scalar tail both run, and the byte found lands in each of them
+    ///
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<int> pick(0, 255);
+    for (size_t count = 1; count <= 4; ++count)
+    {
+        for (size_t length : { 0, 1, 15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64, 65, 100 })
+        {
+            const Ranges ranges = RandomRanges(count, generator);
+            std::vector<uint8_t> members, others;
+            for (int byte = 0; byte < 256; ++byte)
+            {
+                (ranges.Contains(static_cast<uint8_t>(byte)) ? members : others).push_back(static_cast<uint8_t>(byte));
+            }
+            auto from = [&](const std::vector<uint8_t>& set)
+            {
+                return set[static_cast<size_t>(pick(generator)) % set.size()];
+            };
+
+            /// random bytes, then runs of one kind with a single byte of the
+            /// other kind at each position (and none at all)
+            ///
+            std::vector<uint8_t> bytes(length);
+            for (uint8_t& byte : bytes) byte = static_cast<uint8_t>(pick(generator));
+            CheckKernels(bytes, ranges);
+
+            for (size_t at = 0; at <= length; ++at)
+            {
+                std::vector<uint8_t> noMembers(length), allMembers(length);
+                for (size_t byteI = 0; byteI < length; ++byteI)
+                {
+                    noMembers[byteI] = from(others);
+                    allMembers[byteI] = from(members);
+                }
+                if (at < length)
+                {
+                    noMembers[at] = from(members);
+                    allMembers[at] = from(others);
+                }
+                CheckKernels(noMembers, ranges);
+                CheckKernels(allMembers, ranges);
+            }
+        }
+    }
+}
+
+TEST_CASE(SimdKernelsFindHighBytes)
+{
+    /// bytes at and above 0x80 are negative as signed chars
+    ///
+    const Ranges ranges{ .lo = { 0x80, 0xF0 }, .hi = { 0x9F, 0xFF }, .count = 2 };
+    for (size_t length : { 16, 32, 48 })
+    {
+        for (size_t at = 0; at < length; ++at)
+        {
+            std::vector<uint8_t> bytes(length, 0x7F);
+            bytes[at] = (at % 2 == 0 ? 0x80 : 0xFF);
+            CheckKernels(bytes, ranges);
+
+            std::vector<uint8_t> high(length, 0xF5);
+            high[at] = 0xA0;
+            CheckKernels(high, ranges);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/// @file StaticDFATests.cpp
+/// @brief Tests of StaticDFABuilder, against the dfa built at runtime
+
+#include "Fixtures.hpp"
+#include "Test.hpp"
+
+#include "DFA.hpp"
+#include "NFABuilder.hpp"
+#include "PreProcessor.hpp"
+#include "Scanner.hpp"
+#include "StaticDFA.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Fixtures;
+
+/// the shorthands and escapes are read as PreProcessor reads them
+///
+static_assert(StaticDFABuilder::Build<"\\d\\d*">().LongestMatch("42x").length == 2);
+static_assert(StaticDFABuilder::Build<"\\d">().LongestMatch("d").length == 0);
+static_assert(StaticDFABuilder::Build<"[\\w\\-]x">().LongestMatch("-x").length == 2);
+
+/// @brief check the longest match of a static dfa against the runtime dfa of the
+///        same patterns, at every offset of random inputs
+/// @tparam Patterns the patterns of the cases, in order
+/// @param bytes the bytes the inputs are drawn from
+template <FixedString... Patterns>
+static void CheckAgainstRuntime(std::string_view bytes)
+{
+    static constexpr auto staticDfa = StaticDFABuilder::Build<Patterns...>();
+
+    DFA dfa(NFABuilder::Build({ RegexRule(std::string(Patterns.View()))... }));
+    DFA::Minimize(dfa);
+    const DFA::Tables tables = dfa.View();
+
+    for (unsigned seed = 0; seed < 3; ++seed)
+    {
+        const std::string input = RandomInput(bytes, 300, seed);
+        for (size_t offset = 0; offset < input.size(); ++offset)
+        {
+            Scanner::Munch munch = Scanner::Begin(tables);
+            Scanner::Advance(tables, munch, input.data() + offset, input.data() + input.size());
+
+            const auto match = staticDfa.LongestMatch(std::string_view(input).substr(offset));
+            CHECK(match.tag == munch.tag);
+            CHECK(match.length == munch.length);
+        }
+    }
+}
+
+TEST_CASE(StaticDFAMatchesRuntime)
+{
+    CheckAgainstRuntime<"if", "else", "while", "[a-z_][a-z0-9_]*", "[0-9][0-9]*",
+        "[ \t\n][ \t\n]*">("ifelswh_az09 \t\n#");
+    CheckAgainstRuntime<"\\d\\d*", "\\w\\w*", "\\s", "\\D", "[^\\s\\d]">("09az_ \t-#");
+
+    /// a star of a fragment that loops on its own start, and bytes outside of
+    /// the alphabet, which no transition reads
+    ///
+    CheckAgainstRuntime<"(a*b)*", "a*c">("abc");
+    CheckAgainstRuntime<"[\\w\\-]x", "[^a-z0-9]", "(dog)|(cat)", "[a-c]*x">("abcxdogt-9 Z\x80\x01");
+    CheckAgainstRuntime<"(ab|cd)(ef|g)", "a(b|c)*d", "\\[\\]|\\\\", "a.b">("abcdefg[]\\.");
+}
+
+TEST_CASE(StaticDFASharesPatternErrors)
+{
+    /// the checks failing the compilation of an invalid static pattern are the
+    /// ones rejecting it at runtime
+    ///
+    for (std::string pattern : { "[z-a]", "[a", "a]", "[]", "a\\" })
+    {
+        bool threw = false;
+        try
+        {
+            PreProcessor::PreProcessRegex(pattern);
+        }
+        catch ( std::invalid_argument& )
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
@@ -0,0 +1,52 @@
+/// @file Test.hpp
+/// @brief Provides a minimal test registry. TEST_CASE defines and registers a test,
+///        CHECK records a failed condition and carries on, REQUIRE records it and
+///        ends the test
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace Test
+{
+    /// @brief a registered test
+    struct Case
+    {
+        std::string_view name; ///< name of the test function
+        void (*run)(); ///< the test function
+    };
+
+    /// @brief thrown by REQUIRE to end the running test
+    struct Abort { };
+
+    /// @brief get every registered test, in registration order
+    std::vector<Case>& Registry();
+
+    /// @brief record a failed condition of the running test
+    /// @param file the file of the condition
+    /// @param line the line of the condition
+    /// @param condition the text of the condition
+    void Fail(const char* file, size_t line, std::string_view condition);
+
+    /// @brief registers a test when constructed (at static initialization)
+    struct Registrar
+    {
+        Registrar(std::string_view name, void (*run)()) { Registry().push_back(Case{ name, run }); }
+    };
+};
+
+/// @brief macro to define and register a test, e.g. TEST_CASE(EofRuleBuilds) { ... }
+#define TEST_CASE(xName) \
+    static void xName(); \
+    static const Test::Registrar xName##Registrar(#xName, xName); \
+    static void xName()
+
+/// @brief macro to record a failure of the running test if a condition is false
+#define CHECK(...) \
+    do { if (!(__VA_ARGS__)) Test::Fail(__FILE__, __LINE__, #__VA_ARGS__); } while (0)
+
+/// @brief macro to record a failure and end the running test if a condition is false
+#define REQUIRE(...) \
+    do { if (!(__VA_ARGS__)) { Test::Fail(__FILE__, __LINE__, #__VA_ARGS__); throw Test::Abort{ }; } } while (0)
@@ -0,0 +1,70 @@
+/// @file main.cpp
+/// @brief Runs the registered tests
+///
+/// usage: tests [--filter TEXT]
+///        --filter runs the tests whose name contains TEXT
+
+#include "Test.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief number of failed conditions of the running test
+static size_t numFailures = 0;
+
+std::vector<Test::Case>& Test::Registry()
+{
+    static std::vector<Case> registry;
+    return registry;
+}
+
+void Test::Fail(const char* file, size_t line, std::string_view condition)
+{
+    ++numFailures;
+    std::cerr << std::format("    {}:{}: failed: {}\n", file, line, condition);
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    for (int argI = 1; argI < argc; ++argI)
+    {
+        const std::string_view arg = argv[argI];
+        if (arg == "--filter" && argI + 1 < argc) filter = argv[++argI];
+        else
+        {
+            std::cerr << std::format("Unknown option {}\nusage: tests [--filter TEXT]\n", arg);
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t numRun = 0, numFailed = 0;
+    for (const Test::Case& test : Test::Registry())
+    {
+        if (test.name.find(filter) == std::string_view::npos) continue;
+
+        /// a test fails if a condition fails, or anything escapes it
+        ///
+        numFailures = 0;
+        std::cerr << std::format("{}\n", test.name);
+        try
+        {
+            test.run();
+        }
+        catch ( Test::Abort& ) { }
+        catch ( std::exception& e )
+        {
+            Test::Fail(__FILE__, __LINE__, std::format("unexpected exception: {}", e.what()));
+        }
+        ++numRun;
+        numFailed += (numFailures != 0);
+    }
+
+    std::cerr << std::format("{} of {} tests passed\n", numRun - numFailed, numRun);
+    return (numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}